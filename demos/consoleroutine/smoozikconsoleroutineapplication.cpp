@@ -51,7 +51,7 @@ int SmoozikConsoleRoutineApplication::run()
         return -1;
     }
 
-    out << QString("Logged in '%1' venue.\n").arg(xml["place"].toMap()["name"].toString());
+    out << QString("Logged in '%1' venue.\n").arg(xml.value("place/name").toString());
 
     // Start party
     reply = manager.startParty();
@@ -62,7 +62,7 @@ int SmoozikConsoleRoutineApplication::run()
         return -1;
     }
 
-    out << QString("Party started. Private code is '%1'.\n").arg(xml["party"].toMap()["code"].toString());
+    out << QString("Party started. Private code is '%1'.\n").arg(xml.value("party/code").toString());
 
     //Create playlist
     SmoozikPlaylist playlist;
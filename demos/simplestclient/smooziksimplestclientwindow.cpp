@@ -36,7 +36,7 @@ SmoozikSimplestClientWindow::SmoozikSimplestClientWindow(QWidget *parent) :
     // Initialize SmoozikManager
     smoozikManager = new SmoozikManager(APIKEY, SECRET, SmoozikManager::XML, false, this);
     smoozikPlaylist = new SmoozikPlaylist;
-    connect(smoozikManager, SIGNAL(finished(QNetworkReply*)), this, SLOT(processNetworkReply(QNetworkReply*)));
+    connect(smoozikManager, SIGNAL(requestFinished(QNetworkReply*)), this, SLOT(processNetworkReply(QNetworkReply*)));
 
     // Initialize music directory
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
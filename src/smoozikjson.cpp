@@ -0,0 +1,304 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smoozikjson.h"
+#include "smoozikxml.h"
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#include <QJsonDocument>
+#include <QJsonArray>
+#endif
+
+SmoozikJson::SmoozikJson(QObject *parent) :
+    QObject(parent)
+{
+    reset();
+}
+
+SmoozikJson::SmoozikJson(QNetworkReply *reply, QObject *parent) :
+    QObject(parent)
+{
+    reset();
+    parse(reply);
+}
+
+SmoozikJson::~SmoozikJson()
+{
+
+}
+
+void SmoozikJson::reset()
+{
+    _error = SmoozikManager::NoError;
+    _errorMsg = QString();
+    setParsed(QVariant());
+}
+
+bool SmoozikJson::parse(QNetworkReply *reply)
+{
+    QByteArray data = reply->readAll();
+    reply->deleteLater();
+    return parse(data);
+}
+
+bool SmoozikJson::parse(const QByteArray &data)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    QJsonValue dataValue;
+    if (!readEnvelope(data, &dataValue)) {
+        return false;
+    }
+    setParsed(toVariant(dataValue, "data"));
+    return true;
+#else
+    reset();
+    Q_UNUSED(data);
+    _error = SmoozikManager::ParseError;
+    _errorMsg = tr("Could not parse json : JSON responses require Qt 5.");
+    return false;
+#endif
+}
+
+SmoozikPlaylist *SmoozikJson::parseTracks(QNetworkReply *reply, QObject *parent)
+{
+    QByteArray data = reply->readAll();
+    reply->deleteLater();
+    return parseTracks(data, parent);
+}
+
+SmoozikPlaylist *SmoozikJson::parseTracks(const QByteArray &data, QObject *parent)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    QJsonValue dataValue;
+    if (!readEnvelope(data, &dataValue)) {
+        return 0;
+    }
+
+    SmoozikPlaylist *playlist = new SmoozikPlaylist(parent);
+    QJsonArray tracks = dataValue.toObject().value("tracks").toArray();
+    for (QJsonArray::const_iterator it = tracks.constBegin(); it != tracks.constEnd(); ++it) {
+        QJsonObject track = (*it).toObject();
+
+        // Items may be wrapped as in XML responses
+        if (track.size() == 1 && track.value("track").isObject()) {
+            track = track.value("track").toObject();
+        }
+        if (!track.isEmpty()) {
+            readTrack(track, playlist);
+        }
+    }
+    return playlist;
+#else
+    Q_UNUSED(parent);
+    parse(data);
+    return 0;
+#endif
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+bool SmoozikJson::readEnvelope(const QByteArray &data, QJsonValue *dataValue)
+{
+    reset();
+
+    if (data.isEmpty()) {
+        _error = SmoozikManager::ServerUnreachable;
+        _errorMsg = tr("Could not reach server.");
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(data, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        _error = SmoozikManager::ParseError;
+        _errorMsg = tr("Could not parse json : %1 (offset: %2).").arg(parseError.errorString()).arg(parseError.offset);
+        return false;
+    }
+
+    QJsonObject root = document.object();
+    if (root.value("smoozik").isObject()) {
+        root = root.value("smoozik").toObject();
+    } else if (!root.contains("status")) {
+        _error = SmoozikManager::ParseError;
+        _errorMsg = tr("Could not parse json : %1 element is missing.").arg("smoozik");
+        return false;
+    }
+
+    if (!root.contains("status")) {
+        _error = SmoozikManager::ParseError;
+        _errorMsg = tr("Could not parse json : %1 element is missing.").arg("status");
+        return false;
+    }
+
+    if (toString(root.value("status")) == "failed") {
+        if (!root.value("error").isObject()) {
+            _error = SmoozikManager::ParseError;
+            _errorMsg = tr("Could not parse json : %1 element is missing.").arg("failed");
+            return false;
+        }
+
+        QJsonObject error = root.value("error").toObject();
+        if (!error.contains("code")) {
+            _error = SmoozikManager::ParseError;
+            _errorMsg = tr("Could not parse json : %1 element is missing.").arg("code");
+            return false;
+        }
+
+        _error = (SmoozikManager::Error)toString(error.value("code")).toInt();
+        _errorMsg = toString(error.value("message"));
+        return false;
+    }
+
+    if (!root.contains("data")) {
+        _error = SmoozikManager::ParseError;
+        _errorMsg = tr("Could not parse json : %1 element is missing.").arg("data");
+        return false;
+    }
+
+    *dataValue = root.value("data");
+    return true;
+}
+
+QVariant SmoozikJson::toVariant(const QJsonValue &value, const QString &name)
+{
+    if (value.isObject()) {
+        QVariantMap map;
+        QJsonObject object = value.toObject();
+        for (QJsonObject::const_iterator it = object.constBegin(); it != object.constEnd(); ++it) {
+            map.insert(it.key(), toVariant(it.value(), it.key()));
+        }
+        return map;
+    }
+
+    if (value.isArray()) {
+        // Items of an array are named as XML elements of a list: "tracks" contains "track" items
+        QString itemName = name.endsWith('s') ? name.left(name.length() - 1) : name;
+        QVariantList list;
+        QJsonArray array = value.toArray();
+        for (QJsonArray::const_iterator it = array.constBegin(); it != array.constEnd(); ++it) {
+            QJsonValue item = *it;
+            if (item.isObject() && item.toObject().size() == 1 && item.toObject().contains(itemName)) {
+                list.append(toVariant(item, name));
+            } else {
+                QVariantMap map;
+                map.insert(itemName, toVariant(item, itemName));
+                list.append(map);
+            }
+        }
+        return list;
+    }
+
+    return toString(value);
+}
+
+QString SmoozikJson::toString(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::String:
+        return value.toString();
+    case QJsonValue::Double: {
+        double number = value.toDouble();
+        // Integers up to 2^53 are exact, print them without exponent
+        if (qAbs(number) < 9007199254740992.0 && number == (qint64)number) {
+            return QString::number((qint64)number);
+        }
+        return QString::number(number, 'g', 15);
+    }
+    case QJsonValue::Bool:
+        return value.toBool() ? "1" : "0";
+    default:
+        return QString();
+    }
+}
+
+double SmoozikJson::toDouble(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::Double:
+        return value.toDouble();
+    case QJsonValue::String:
+        return value.toString().toDouble();
+    case QJsonValue::Bool:
+        return value.toBool() ? 1 : 0;
+    default:
+        return 0;
+    }
+}
+
+void SmoozikJson::readTrack(const QJsonObject &track, SmoozikPlaylist *playlist)
+{
+    playlist->addTrack(toString(track.value("localId")),
+                       toString(track.value("name")),
+                       toString(track.value("artist")),
+                       toString(track.value("album")),
+                       qRound(toDouble(track.value("duration"))),
+                       toString(track.value("fileName")));
+}
+#endif
+
+const QVariant &SmoozikJson::operator [](const QString &key) const
+{
+    return SmoozikXml::child(_parsed, key);
+}
+
+const QVariant &SmoozikJson::operator [](const int i) const
+{
+    return SmoozikXml::child(_parsed, i);
+}
+
+const QVariant &SmoozikJson::value(const QString &path) const
+{
+    QHash<QString, const QVariant *>::const_iterator it = _pathIndex.constFind(path);
+    if (it != _pathIndex.constEnd()) {
+        return *it.value();
+    }
+
+    const QVariant &value = SmoozikXml::find(_parsed, path);
+    _pathIndex.insert(path, &value);
+    return value;
+}
+
+void SmoozikJson::setParsed(const QVariant &parsed)
+{
+    _parsed = parsed;
+    _pathIndex.clear();
+}
+
+QString SmoozikJson::print() const
+{
+    return SmoozikXml::printVariant(_parsed, 0);
+}
+
+void SmoozikJson::print(QTextStream &stream) const
+{
+    SmoozikXml::printVariant(stream, _parsed, 0);
+}
+
+void SmoozikJson::printJsonLine(QTextStream &stream) const
+{
+    stream << "{\"error\":" << (int) _error;
+    if (_error != SmoozikManager::NoError) {
+        stream << ",\"errorMsg\":";
+        SmoozikXml::printJson(stream, _errorMsg);
+    }
+    if (!_parsed.isNull()) {
+        stream << ",\"data\":";
+        SmoozikXml::printJson(stream, _parsed);
+    }
+    stream << "}\n";
+}
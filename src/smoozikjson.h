@@ -0,0 +1,222 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKJSON_H
+#define SMOOZIKJSON_H
+
+#include <QObject>
+#include <QVariant>
+#include <QTextStream>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#include <QJsonValue>
+#include <QJsonObject>
+#endif
+
+#include "smoozikmanager.h"
+
+/**
+ * @brief The SmoozikJson class provides with functions to parse JSON response from Smoozik webserver
+ *
+ * It is the JSON counterpart of SmoozikXml, to be used with a SmoozikManager in SmoozikManager::JSON format.
+ * Parsed data is converted to the same QVariant tree as SmoozikXml:
+ * values are QString, and an array named after its items (e.g. "tracks") is a QVariantList of single entry QVariantMap (e.g. "track").
+ *
+ * JSON parsing requires Qt 5. With Qt 4, parsing always fails with SmoozikManager::ParseError.
+ */
+class SMOOZIKLIB_EXPORT SmoozikJson : public QObject
+{
+    /**
+     * @brief This property holds the error encountered in last parse() call.
+     *
+     * If no error where found in last parse() call or if parse() has not ever been called, returns SmoozikManager::NoError
+     * @af error()
+     * @pm _error
+     */
+    Q_PROPERTY(SmoozikManager::Error error READ error)
+    /**
+     * @brief This property holds the error message of the error encountered in last parse() call.
+     *
+     * If no error where found in last parse() call or if parse() has not ever been called, returns a null String.
+     * @af errorMsg()
+     * @pm _errorMsg
+     */
+    Q_PROPERTY(QString errorMsg READ errorMsg)
+    Q_OBJECT
+
+public:
+    explicit SmoozikJson(QObject *parent = 0);
+    /**
+     * @brief Constructs a SmoozikJson and parses the reply.
+     * @sa parse()
+     */
+    explicit SmoozikJson(QNetworkReply *reply, QObject *parent = 0);
+
+    ~SmoozikJson();
+
+    inline SmoozikManager::Error error() const {
+        return _error;
+    } /**< @see #error */
+
+    inline QString errorMsg() const {
+        return _errorMsg;
+    } /**< @see #errorMsg */
+
+    /**
+     * @brief Parses response from Smoozik Server.
+     *
+     * The reply is deleted during the process.
+     * @param reply Response from Smoozik Server
+     * @retval true if parsing succeeded. Data is accessible with operator [].
+     * @retval false if parsing failed. Error is accessible with error().
+     */
+    bool parse(QNetworkReply *reply);
+
+    /**
+     * @brief Parses response @em data from Smoozik Server.
+     * @overload
+     */
+    bool parse(const QByteArray &data);
+
+    /**
+     * @brief Parses a getTopTracks response from Smoozik Server directly into a new playlist.
+     *
+     * Tracks are read from the "tracks" array of the response data without building any intermediate QVariant.
+     * The reply is deleted during the process.
+     * @param reply Response from Smoozik Server
+     * @param parent Parent of the returned playlist
+     * @return The playlist, or 0 if parsing failed. Error is accessible with error().
+     */
+    SmoozikPlaylist *parseTracks(QNetworkReply *reply, QObject *parent = 0);
+
+    /**
+     * @brief Parses getTopTracks response @em data directly into a new playlist.
+     * @overload
+     */
+    SmoozikPlaylist *parseTracks(const QByteArray &data, QObject *parent = 0);
+
+    /**
+     * @brief Returns the element at @em key of #_parsed if #_parsed is a QMap.
+     *
+     * This element might either be a QString (accessible through QVariant::toString()),
+     * a QList (accessible through QVariant::toList())
+     * or a QMap (accessible through QVariant::toMap()).
+     * The element is returned by reference, without copying #_parsed.
+     */
+    const QVariant &operator[] (const QString &key) const;
+
+    /**
+     * @brief Returns the element at index position @em i of #_parsed if #_parsed is a QList.
+     *
+     * This element might either be a QString (accessible through QVariant::toString()),
+     * a QList (accessible through QVariant::toList())
+     * or a QMap (accessible through QVariant::toMap()).
+     * The element is returned by reference, without copying #_parsed.
+     */
+    const QVariant &operator[] (const int i) const;
+
+    /**
+     * @brief Returns the element at @em path of #_parsed, or a null QVariant if there is no such element.
+     *
+     * A path is a list of map keys and list indexes separated by '/', e.g. "party/code" or "tracks/3/track/name".
+     * The element is returned by reference, and found paths are indexed so that a path is only walked once per response.
+     */
+    const QVariant &value(const QString &path) const;
+
+    /**
+     * @brief if _parsed is a QString, return this string; else returns an empty string.
+     */
+    inline QString parsedString() const {
+        return _parsed.toString();
+    }
+
+    /**
+     * @brief Returns a structured string of the parsed json to print.
+     * @return A structured string
+     */
+    QString print() const;
+
+    /**
+     * @brief Writes the structured string returned by print() to @em stream, without building it in memory.
+     */
+    void print(QTextStream &stream) const;
+
+    /**
+     * @brief Writes the result of the last parsed response to @em stream as a single line of JSON.
+     * @see SmoozikXml::printJsonLine()
+     */
+    void printJsonLine(QTextStream &stream) const;
+
+private:
+    /**
+     * @brief This property holds the QVariant containing the parsed json.
+     */
+    QVariant _parsed;
+    SmoozikManager::Error _error; /**< @see #error */
+    QString _errorMsg; /**< @see #errorMsg */
+
+    /**
+     * @brief This property holds the elements of #_parsed already found by value(), by path.
+     */
+    mutable QHash<QString, const QVariant *> _pathIndex;
+
+    /**
+     * @brief Sets #_parsed to @em parsed and clears #_pathIndex.
+     */
+    void setParsed(const QVariant &parsed);
+
+    /**
+     * @brief Cleans error, error message and parsed data.
+     */
+    void reset();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    /**
+     * @brief Parses @em data and checks its status and error.
+     * @param data Response from Smoozik Server
+     * @param dataValue Set to the data of the response if the response succeeded
+     * @return true if the response succeeded
+     */
+    bool readEnvelope(const QByteArray &data, QJsonValue *dataValue);
+
+    /**
+     * @brief Returns @em value converted with the same rules as SmoozikXml::parseElement().
+     * @param value JSON value
+     * @param name Name of the value in its parent object, used to name array items
+     */
+    static QVariant toVariant(const QJsonValue &value, const QString &name);
+
+    /**
+     * @brief Returns scalar @em value as a string, as it would be written in a XML response.
+     */
+    static QString toString(const QJsonValue &value);
+
+    /**
+     * @brief Returns scalar @em value as a number, 0 if it is neither a number nor a numeric string.
+     */
+    static double toDouble(const QJsonValue &value);
+
+    /**
+     * @brief Adds track @em track to @em playlist.
+     */
+    static void readTrack(const QJsonObject &track, SmoozikPlaylist *playlist);
+#endif
+};
+
+#endif // SMOOZIKJSON_H
@@ -23,24 +23,302 @@
 SmoozikManager::SmoozikManager(const QString &apiKey, const SmoozikManager::Format &format, bool blocking, QObject *parent) :
     QNetworkAccessManager(parent)
 {
-    setApiKey(apiKey);
-    setSecret(QString());
-    setFormat(format);
-    setBlocking(blocking);
+    init(apiKey, QString(), format, blocking);
 }
 
 SmoozikManager::SmoozikManager(const QString &apiKey, const QString &secret, const SmoozikManager::Format &format, bool blocking, QObject *parent) :
     QNetworkAccessManager(parent)
+{
+    init(apiKey, secret, format, blocking);
+}
+
+void SmoozikManager::init(const QString &apiKey, const QString &secret, const SmoozikManager::Format &format, bool blocking)
 {
     setApiKey(apiKey);
     setSecret(secret);
     setFormat(format);
     setBlocking(blocking);
+    setTimeout(-1);
+    setBaseUrl(QUrl("http://www.smoozik.com/index.php/api/"));
+    setSecure(false);
+    setCacheTtl(0);
+    setStaleWhileRevalidate(0);
+    setDeduplicateReads(true);
+    setMaxRetries(3);
+    setRetryDelay(500);
+    setMaxRetryDelay(30000);
+    setCircuitBreakerThreshold(5);
+    setCircuitBreakerTimeout(30000);
+    setPlaylistDeltaThreshold(-1);
+    setIdempotent("getTopTracks");
+    _randomState = quint32(QDateTime::currentMSecsSinceEpoch()) ^ quint32(quintptr(this));
+    if (_randomState == 0) {
+        _randomState = 0x9e3779b9;
+    }
+    setMaxRequestsPerHost(6);
+    resetConnectionStatistics();
+    setCompressionThreshold(-1);
+    setAcceptCompressedResponses(false);
+    setBatchInterval(0);
+    setBatchSize(10);
+    setReadOnly("getTopTracks");
+    _stageSent = false;
+    _batchTimer.setSingleShot(true);
+    connect(&_batchTimer, SIGNAL(timeout()), this, SLOT(flushBatch()));
 }
 
 SmoozikManager::~SmoozikManager()
 {
+    // QNetworkAccessManager destructor deletes remaining replies once members used by their slots are destroyed, so they are deleted here first
+    _batchTimer.stop();
+    _batch.clear();
+    _stages.clear();
+    _hosts.clear();
+    _pendingReads.clear();
+    _pendingReadKeys.clear();
+    invalidateCache();
+
+    QList<QNetworkReply *> replies = findChildren<QNetworkReply *>();
+    foreach(QNetworkReply *reply, replies) {
+        disconnect(reply, 0, this, 0);
+    }
+
+    // Network replies first, so that SmoozikReply objects do not abort them while being deleted
+    QList<QObject *> networkReplies = _networkReplies.keys();
+    _networkReplies.clear();
+    _inFlightHosts.clear();
+    foreach(QObject *object, networkReplies) {
+        QNetworkReply *reply = static_cast<QNetworkReply *>(object);
+        reply->abort();
+        delete reply;
+    }
+    qDeleteAll(findChildren<SmoozikReply *>());
+}
+
+void SmoozikManager::setMaxRequestsPerHost(int maxRequestsPerHost)
+{
+    _maxRequestsPerHost = maxRequestsPerHost;
+
+    foreach(const QString &key, _hosts.keys()) {
+        processQueue(key);
+    }
+}
+
+void SmoozikManager::setBaseUrl(const QUrl &baseUrl)
+{
+    _baseUrl = baseUrl;
+    if (!_baseUrl.path().endsWith('/')) {
+        _baseUrl.setPath(_baseUrl.path() + '/');
+    }
+    clearEndpoints();
+}
+
+void SmoozikManager::setSecure(bool secure)
+{
+    _secure = secure;
+    clearEndpoints();
+}
+
+QUrl SmoozikManager::endpoint(const QString &method) const
+{
+    QHash<QString, Endpoint>::const_iterator i = _endpoints.constFind(method);
+    if (i != _endpoints.constEnd()) {
+        return i.value().url;
+    }
+
+    Endpoint endpoint;
+    endpoint.url = createEndpoint(method);
+    endpoint.overridden = false;
+    _endpoints.insert(method, endpoint);
+    return endpoint.url;
+}
+
+void SmoozikManager::setEndpoint(const QString &method, const QUrl &url)
+{
+    if (!url.isValid()) {
+        _endpoints.remove(method);
+        return;
+    }
+
+    Endpoint endpoint;
+    endpoint.url = url;
+    endpoint.overridden = true;
+    _endpoints.insert(method, endpoint);
+}
+
+QUrl SmoozikManager::createEndpoint(const QString &method) const
+{
+    QUrl url = baseUrl();
+    url.setPath(url.path() + method);
+    if (secure()) {
+        url.setScheme("https");
+        if (url.port() == 80) {
+            url.setPort(-1);
+        }
+    }
+    return url;
+}
+
+void SmoozikManager::clearEndpoints()
+{
+    QMutableHashIterator<QString, Endpoint> i(_endpoints);
+    while (i.hasNext()) {
+        i.next();
+        if (!i.value().overridden) {
+            i.remove();
+        }
+    }
+}
+
+int SmoozikManager::cacheTtl(const QString &method) const
+{
+    if (!isReadOnly(method)) {
+        return 0;
+    }
+    return _methodCacheTtls.value(method, cacheTtl());
+}
+
+void SmoozikManager::setCacheTtl(const QString &method, int cacheTtl)
+{
+    if (cacheTtl < 0) {
+        _methodCacheTtls.remove(method);
+    } else {
+        _methodCacheTtls.insert(method, cacheTtl);
+    }
+}
+
+void SmoozikManager::invalidateCache()
+{
+    foreach(const CacheEntry &entry, _cache) {
+        delete entry.reply;
+    }
+    _cache.clear();
+}
+
+void SmoozikManager::invalidateCache(const QString &method)
+{
+    QMutableHashIterator<QByteArray, CacheEntry> i(_cache);
+    while (i.hasNext()) {
+        i.next();
+        if (i.value().reply->method() == method) {
+            delete i.value().reply;
+            i.remove();
+        }
+    }
+}
+
+void SmoozikManager::cacheReply(SmoozikReply *smoozikReply)
+{
+    if (smoozikReply->error() != QNetworkReply::NoError || smoozikReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
+        return;
+    }
+
+    CacheEntry &entry = _cache[smoozikReply->_cacheKey];
+    delete entry.reply;
+    entry.reply = new SmoozikReply(smoozikReply->method(), smoozikReply->request(), QByteArray(), this);
+    entry.reply->completeFrom(smoozikReply);
+    entry.storedAt.start();
+    entry.revalidating = false;
+}
+
+void SmoozikManager::setConditionalHeaders(QNetworkRequest *request, const CacheEntry &entry)
+{
+    if (entry.reply->hasRawHeader("ETag")) {
+        request->setRawHeader("If-None-Match", entry.reply->rawHeader("ETag"));
+    }
+    if (entry.reply->hasRawHeader("Last-Modified")) {
+        request->setRawHeader("If-Modified-Since", entry.reply->rawHeader("Last-Modified"));
+    }
+}
+
+int SmoozikManager::maxRetries(const QString &method) const
+{
+    if (!isIdempotent(method)) {
+        return 0;
+    }
+    return _methodMaxRetries.value(method, maxRetries());
+}
+
+void SmoozikManager::setMaxRetries(const QString &method, int maxRetries)
+{
+    if (maxRetries < 0) {
+        _methodMaxRetries.remove(method);
+    } else {
+        _methodMaxRetries.insert(method, maxRetries);
+    }
+}
+
+void SmoozikManager::setIdempotent(const QString &method, bool idempotent)
+{
+    if (idempotent) {
+        _idempotentMethods.insert(method);
+    } else {
+        _idempotentMethods.remove(method);
+    }
+}
+
+bool SmoozikManager::isCircuitOpen(const QString &method) const
+{
+    QHash<QString, Host>::const_iterator i = _hosts.constFind(hostKey(endpoint(method)));
+    return i != _hosts.constEnd() && i.value().circuitOpen && i.value().circuitOpenedAt.elapsed() < circuitBreakerTimeout();
+}
 
+int SmoozikManager::nextRetryDelay(int retry)
+{
+    qint64 delay = qMax(retryDelay(), 0);
+    for (int i = 0; i < retry && delay < maxRetryDelay(); i++) {
+        delay *= 2;
+    }
+    delay = qMin(delay, qint64(maxRetryDelay()));
+
+    // Xorshift generator
+    _randomState ^= _randomState << 13;
+    _randomState ^= _randomState >> 17;
+    _randomState ^= _randomState << 5;
+
+    return int(delay - _randomState % (delay / 2 + 1));
+}
+
+void SmoozikManager::setBatchInterval(int batchInterval)
+{
+    _batchInterval = batchInterval;
+
+    if (_batchInterval < 1) {
+        flushBatch();
+    }
+}
+
+void SmoozikManager::setReadOnly(const QString &method, bool readOnly)
+{
+    if (readOnly) {
+        _readOnlyMethods.insert(method);
+    } else {
+        _readOnlyMethods.remove(method);
+    }
+}
+
+void SmoozikManager::resetConnectionStatistics()
+{
+    _estimatedConnectionOpenCount = 0;
+    _estimatedConnectionReuseCount = 0;
+    _deduplicatedRequestCount = 0;
+    _cacheHitCount = 0;
+    _notModifiedCount = 0;
+}
+
+int SmoozikManager::inFlightRequestCount() const
+{
+    return _inFlightHosts.size();
+}
+
+int SmoozikManager::queuedRequestCount() const
+{
+    int count = 0;
+
+    foreach(const Host &host, _hosts) {
+        count += host.queue.size();
+    }
+    return count;
 }
 
 QNetworkReply *SmoozikManager::login(const QString &username, const QString &password)
@@ -100,56 +378,109 @@ QNetworkReply *SmoozikManager::unsetAllTracks()
     return request("unsetAllTracks");
 }
 
-QNetworkReply *SmoozikManager::sendPlaylist(const SmoozikPlaylist *playlist)
+/**
+ * @brief Appends a \<partytrack\> element describing @em track to @em parent, as expected by sendPlaylist and updatePlaylist methods.
+ */
+static void appendPartytrack(QDomDocument &doc, QDomElement &parent, const SmoozikTrackData &track)
+{
+    QDomElement partytrackElement = doc.createElement("partytrack");
+    parent.appendChild(partytrackElement);
+
+    // Retrieve localID
+    QDomElement localId = doc.createElement("localId");
+    partytrackElement.appendChild(localId);
+    localId.appendChild(doc.createTextNode(track.localId()));
+
+    QDomElement trackElement = doc.createElement("track");
+    partytrackElement.appendChild(trackElement);
+
+    // Retrieve track name
+    QDomElement name = doc.createElement("name");
+    trackElement.appendChild(name);
+    name.appendChild(doc.createTextNode(track.name()));
+
+    // Retrieve track artist
+    if (!track.artist().isEmpty()) {
+        QDomElement artist = doc.createElement("artistName");
+        trackElement.appendChild(artist);
+        artist.appendChild(doc.createTextNode(track.artist()));
+    }
+
+    // Retrieve track album
+    if (!track.album().isEmpty()) {
+        QDomElement album = doc.createElement("albumName");
+        trackElement.appendChild(album);
+        album.appendChild(doc.createTextNode(track.album()));
+    }
+
+    //Retrieve track duration
+    if (track.duration() > 0) {
+        QDomElement duration = doc.createElement("duration");
+        partytrackElement.appendChild(duration);
+        duration.appendChild(doc.createTextNode(QString::number(track.duration())));
+    }
+}
+
+/**
+ * @brief Returns a \<partytracks\> document describing @em tracks, as expected by sendPlaylist and updatePlaylist methods.
+ */
+static QString partytracksData(const QList<SmoozikTrackData> &tracks)
 {
     QDomDocument doc;
     QDomElement partytracksElement = doc.createElement("partytracks");
     doc.appendChild(partytracksElement);
 
-    for (int i = 0; i < playlist->size(); i++) {
-        QDomElement partytrackElement = doc.createElement("partytrack");
-        partytracksElement.appendChild(partytrackElement);
+    foreach(const SmoozikTrackData &track, tracks) {
+        appendPartytrack(doc, partytracksElement, track);
+    }
+    return doc.toString();
+}
 
-        // Retrieve localID
-        QDomElement localId = doc.createElement("localId");
-        partytrackElement.appendChild(localId);
-        localId.appendChild(doc.createTextNode(playlist->value(i)->localId()));
+QNetworkReply *SmoozikManager::sendPlaylist(const SmoozikPlaylist *playlist)
+{
+    QMap<QString, QString> postParams;
+    postParams.insert("data", partytracksData(playlist->tracks()));
 
-        QDomElement trackElement = doc.createElement("track");
-        partytrackElement.appendChild(trackElement);
+    return request("sendPlaylist", QMap<QString, QString>(), postParams);
+}
 
-        // Retrieve track name
-        QDomElement name = doc.createElement("name");
-        trackElement.appendChild(name);
-        name.appendChild(doc.createTextNode(playlist->value(i)->name()));
+QNetworkReply *SmoozikManager::sendPlaylist(const SmoozikPlaylistView *playlist)
+{
+    QMap<QString, QString> postParams;
+    postParams.insert("data", partytracksData(playlist->tracks()));
 
-        // Retrieve track artist
-        if (!playlist->value(i)->artist().isEmpty()) {
-            QDomElement artist = doc.createElement("artistName");
-            trackElement.appendChild(artist);
-            artist.appendChild(doc.createTextNode(playlist->value(i)->artist()));
-        }
+    return request("sendPlaylist", QMap<QString, QString>(), postParams);
+}
 
-        // Retrieve track album
-        if (!playlist->value(i)->album().isEmpty()) {
-            QDomElement album = doc.createElement("albumName");
-            trackElement.appendChild(album);
-            album.appendChild(doc.createTextNode(playlist->value(i)->album()));
-        }
+QNetworkReply *SmoozikManager::updatePlaylist(const SmoozikPlaylist *previous, const SmoozikPlaylist *playlist)
+{
+    if (!previous || playlistDeltaThreshold() < 0) {
+        return sendPlaylist(playlist);
+    }
 
-        //Retrieve track duration
-        if (playlist->value(i)->duration() > 0) {
-            QDomElement duration = doc.createElement("duration");
-            partytrackElement.appendChild(duration);
-            duration.appendChild(doc.createTextNode(QString::number(playlist->value(i)->duration())));
-        }
+    SmoozikPlaylistDelta delta(previous, playlist);
+    if (delta.isEmpty()) {
+        return 0;
+    }
+    if ((qint64)delta.count() * 100 > (qint64)playlistDeltaThreshold() * playlist->size()) {
+        return sendPlaylist(playlist);
+    }
+
+    QDomDocument removedDoc;
+    QDomElement localIdsElement = removedDoc.createElement("localIds");
+    removedDoc.appendChild(localIdsElement);
+    foreach(const QString &removed, delta.removed()) {
+        QDomElement localId = removedDoc.createElement("localId");
+        localIdsElement.appendChild(localId);
+        localId.appendChild(removedDoc.createTextNode(removed));
     }
 
-    QString data = doc.toString();
     QMap<QString, QString> postParams;
-    postParams.insert("data", data);
+    // Added and changed tracks use sendPlaylist format
+    postParams.insert("data", partytracksData(delta.added() + delta.changed()));
+    postParams.insert("removed", removedDoc.toString());
 
-    return request("sendPlaylist", QMap<QString, QString>(), postParams);
+    return request("updatePlaylist", QMap<QString, QString>(), postParams);
 }
 
 QNetworkReply *SmoozikManager::forceDisconnectUsers(int lastTouchDelay)
@@ -160,110 +491,459 @@ QNetworkReply *SmoozikManager::forceDisconnectUsers(int lastTouchDelay)
     return request("forceDisconnectUsers", QMap<QString, QString>(), postParams);
 }
 
-QNetworkReply *SmoozikManager::request(const QString &method, QMap<QString, QString> getParams, QMap<QString, QString> postParams)
+void SmoozikManager::prepareRequest(const QString &method, const QMap<QString, QString> &getParams, const QMap<QString, QString> &postParams, QNetworkRequest *request, QByteArray *postData) const
 {
-    QNetworkRequest request;
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    request->setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     //Add format
     switch (format()) {
     case XML:
-        getParams.insert("format", "xml");
+        _encoder.setFixedGetParameter("format", "xml");
         break;
     case JSON:
-        getParams.insert("format", "json");
+        _encoder.setFixedGetParameter("format", "json");
         break;
     }
 
-    //Add key
-    postParams.insert("apiKey", apiKey());
+    //Add key and sessionKey
+    _encoder.setFixedPostParameter("apiKey", apiKey());
+    _encoder.setFixedPostParameter("sessionKey", sessionKey());
 
-    //Add sessionKey
-    postParams.insert("sessionKey", sessionKey());
+    //Sign and encode data
+    _encoder.encode(getParams, postParams, secret());
 
-    //Process signature
-    QStringList keyList;
+    //Construct request
+    QUrl url = endpoint(method);
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-    QUrl postData;
+    url.setEncodedQuery(_encoder.getData());
 #else
-    QUrlQuery postData;
+    url.setQuery(QString::fromLatin1(_encoder.getData()));
 #endif
-    QMapIterator<QString, QString> i(postParams);
-    while (i.hasNext()) {
-        i.next();
-        if (!i.value().isEmpty()) {
-            QString key = i.key();
-            QString value = i.value();
-
-#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-            //Percent characters are encoded manually as they are not encoded by Qt encode function.
-            key.replace(QByteArray("%"), QByteArray("%25"));
-            value.replace(QByteArray("%"), QByteArray("%25"));
-#endif
-            postData.addQueryItem(key, value);
-            if (i.key() != "sig") {
-                keyList << i.key();
+    request->setUrl(url);
+    *postData = _encoder.postData();
+
+    //Compress data. HTTP deflate encoding is zlib format, which is qCompress output without its 4 bytes size header.
+    if (compressionThreshold() >= 0 && postData->size() > compressionThreshold()) {
+        QByteArray compressedData = qCompress(*postData).mid(4);
+        if (compressedData.size() < postData->size()) {
+            *postData = compressedData;
+            request->setRawHeader("Content-Encoding", "deflate");
+        }
+    }
+
+    if (acceptCompressedResponses()) {
+        request->setRawHeader("Accept-Encoding", "deflate");
+    }
+}
+
+QNetworkReply *SmoozikManager::request(const QString &method, QMap<QString, QString> getParams, QMap<QString, QString> postParams)
+{
+    SmoozikReply *reply = send(method, getParams, postParams);
+    if (blocking() && !reply->waitForFinished(timeout())) {
+        reply->_timedOut = true;
+        reply->abort();
+    }
+    return reply;
+}
+
+SmoozikReply *SmoozikManager::send(const QString &method, const QMap<QString, QString> &getParams, const QMap<QString, QString> &postParams)
+{
+    QNetworkRequest request;
+    QByteArray postData;
+    prepareRequest(method, getParams, postParams, &request, &postData);
+
+    bool readOnly = isReadOnly(method);
+    QByteArray key;
+    if (readOnly) {
+        key = request.url().toEncoded() + '\n' + _encoder.unsignedPostData();
+    } else {
+        invalidateCache();
+    }
+
+    // Serve from cache, revalidating in the background when stale, or revalidate expired responses with a conditional request
+    int ttl = readOnly ? cacheTtl(method) : 0;
+    bool cached = false;
+    if (ttl > 0) {
+        QHash<QByteArray, CacheEntry>::iterator i = _cache.find(key);
+        if (i != _cache.end()) {
+            qint64 age = i.value().storedAt.elapsed();
+            if (age <= ttl + staleWhileRevalidate()) {
+                cached = true;
+                if (age > ttl && !i.value().revalidating) {
+                    i.value().revalidating = true;
+                    QNetworkRequest revalidationRequest(request);
+                    setConditionalHeaders(&revalidationRequest, i.value());
+                    SmoozikReply *revalidation = new SmoozikReply(method, revalidationRequest, postData, this);
+                    revalidation->_cacheKey = key;
+                    connect(revalidation, SIGNAL(finished()), revalidation, SLOT(deleteLater()));
+                    enqueueRequest(revalidation);
+                }
+            } else {
+                setConditionalHeaders(&request, i.value());
             }
         }
     }
 
-#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-    QUrl getData;
-#else
-    QUrlQuery getData;
-#endif
-    QMapIterator<QString, QString> j(getParams);
-    while (j.hasNext()) {
-        j.next();
-        if (!j.value().isEmpty()) {
-            QString key = j.key();
-            QString value = j.value();
-
-#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-            //Percent characters are encoded manually as they are not encoded by Qt encode function.
-            key.replace(QByteArray("%"), QByteArray("%25"));
-            value.replace(QByteArray("%"), QByteArray("%25"));
-#endif
-            getData.addQueryItem(key, value);
-            if (j.key() != "sig") {
-                keyList << j.key();
+    SmoozikReply *smoozikReply = new SmoozikReply(method, request, postData, this);
+    connect(smoozikReply, SIGNAL(finished()), this, SLOT(smoozikReplyFinished()));
+
+    if (cached) {
+        _cacheHitCount++;
+        smoozikReply->completeLater(_cache.value(key).reply);
+        return smoozikReply;
+    }
+    if (ttl > 0) {
+        smoozikReply->_cacheKey = key;
+    }
+
+    if (deduplicateReads() && readOnly) {
+        QHash<QByteArray, PendingRead>::iterator i = _pendingReads.find(key);
+        if (i != _pendingReads.end() && i.value().leader && !i.value().leader->isFinished()) {
+            i.value().followers.append(smoozikReply);
+            _deduplicatedRequestCount++;
+            return smoozikReply;
+        }
+        setPendingRead(key, smoozikReply, QList<QPointer<SmoozikReply> >());
+    }
+
+    if (batchInterval() > 0) {
+        _batch.append(smoozikReply);
+        if (_batch.size() >= batchSize()) {
+            flushBatch();
+        } else if (!_batchTimer.isActive()) {
+            _batchTimer.start(batchInterval());
+        }
+    } else {
+        enqueueRequest(smoozikReply);
+    }
+
+    return smoozikReply;
+}
+
+void SmoozikManager::setPendingRead(const QByteArray &key, SmoozikReply *smoozikReply, const QList<QPointer<SmoozikReply> > &followers)
+{
+    PendingRead pendingRead;
+    pendingRead.leader = smoozikReply;
+    pendingRead.followers = followers;
+    _pendingReads.insert(key, pendingRead);
+    _pendingReadKeys.insert(smoozikReply, key);
+    connect(smoozikReply, SIGNAL(destroyed(QObject*)), this, SLOT(pendingReadDestroyed(QObject*)), Qt::UniqueConnection);
+}
+
+void SmoozikManager::promoteFollower(const QByteArray &key, const QList<QPointer<SmoozikReply> > &followers)
+{
+    for (int i = 0; i < followers.size(); i++) {
+        SmoozikReply *smoozikReply = followers.at(i);
+        if (smoozikReply && !smoozikReply->isFinished()) {
+            setPendingRead(key, smoozikReply, followers.mid(i + 1));
+            enqueueRequest(smoozikReply);
+            return;
+        }
+    }
+}
+
+void SmoozikManager::pendingReadDestroyed(QObject *smoozikReply)
+{
+    if (!_pendingReadKeys.contains(smoozikReply)) {
+        return;
+    }
+
+    QByteArray key = _pendingReadKeys.take(smoozikReply);
+    promoteFollower(key, _pendingReads.take(key).followers);
+}
+
+void SmoozikManager::flushBatch()
+{
+    _batchTimer.stop();
+    if (_batch.isEmpty()) {
+        return;
+    }
+
+    // Split the batch in stages of consecutive requests of the same kind
+    QList<QPointer<SmoozikReply> > stage;
+    bool stageReadOnly = false;
+
+    foreach(const QPointer<SmoozikReply> &smoozikReply, _batch) {
+        if (!smoozikReply || smoozikReply->isFinished()) {
+            continue;
+        }
+
+        bool readOnly = isReadOnly(smoozikReply->method());
+        if (!stage.isEmpty() && readOnly != stageReadOnly) {
+            _stages.append(stage);
+            stage.clear();
+        }
+        stageReadOnly = readOnly;
+
+        QNetworkRequest request = smoozikReply->request();
+        request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+        smoozikReply->setRequest(request);
+        // Replies deleted before they finish must not stall later stages
+        connect(smoozikReply, SIGNAL(destroyed()), this, SLOT(stagedReplyDestroyed()), Qt::UniqueConnection);
+        stage.append(smoozikReply);
+    }
+    if (!stage.isEmpty()) {
+        _stages.append(stage);
+    }
+    _batch.clear();
+
+    processStages();
+}
+
+void SmoozikManager::processStages()
+{
+    while (!_stages.isEmpty()) {
+        QList<QPointer<SmoozikReply> > &stage = _stages.first();
+        for (int i = stage.size() - 1; i >= 0; i--) {
+            if (!stage.at(i) || stage.at(i)->isFinished()) {
+                stage.removeAt(i);
+            }
+        }
+
+        if (!stage.isEmpty()) {
+            if (!_stageSent) {
+                _stageSent = true;
+                QList<QPointer<SmoozikReply> > replies = stage;
+
+                foreach(const QPointer<SmoozikReply> &smoozikReply, replies) {
+                    if (smoozikReply) {
+                        enqueueRequest(smoozikReply);
+                    }
+                }
+            }
+            return;
+        }
+
+        _stages.removeFirst();
+        _stageSent = false;
+    }
+}
+
+QString SmoozikManager::hostKey(const QUrl &url)
+{
+    int defaultPort = (url.scheme() == "https") ? 443 : 80;
+    return url.scheme() + "://" + url.host() + ":" + QString::number(url.port(defaultPort));
+}
+
+void SmoozikManager::enqueueRequest(SmoozikReply *smoozikReply)
+{
+    QString key = hostKey(smoozikReply->request().url());
+    _hosts[key].queue.enqueue(smoozikReply);
+    processQueue(key);
+}
+
+void SmoozikManager::processQueue(const QString &key)
+{
+    while (_hosts.contains(key)) {
+        Host &host = _hosts[key];
+        if (host.queue.isEmpty() || (maxRequestsPerHost() > 0 && host.inFlight >= maxRequestsPerHost())) {
+            return;
+        }
+
+        if (host.circuitOpen) {
+            if (host.circuitOpenedAt.elapsed() < circuitBreakerTimeout()) {
+                while (!host.queue.isEmpty()) {
+                    QPointer<SmoozikReply> smoozikReply = host.queue.dequeue();
+                    if (smoozikReply && !smoozikReply->isFinished()) {
+                        smoozikReply->failLater(QNetworkReply::TemporaryNetworkFailureError, tr("Server is unavailable, request was not sent."));
+                    }
+                }
+                return;
             }
+
+            // Circuit is half-open: a single request probes the server
+            if (host.inFlight > 0) {
+                return;
+            }
+        }
+
+        // Requests aborted or deleted while queued are skipped
+        QPointer<SmoozikReply> smoozikReply = host.queue.dequeue();
+        if (smoozikReply && !smoozikReply->isFinished()) {
+            startRequest(smoozikReply, key);
         }
     }
+}
+
+void SmoozikManager::startRequest(SmoozikReply *smoozikReply, const QString &key)
+{
+    // Connections are modelled, not observed: Qt opens at most 6 connections to a same host and other requests wait for one of them
+    static const int maxConnections = 6;
 
-    //Process signature
-    keyList.sort();
-    QByteArray sigParams;
-    for (int k = 0; k < keyList.size(); k++) {
-        QByteArray key = keyList.value(k).toUtf8();
-        sigParams += key + getParams[key].toUtf8() + postParams[key].toUtf8();
+    Host &host = _hosts[key];
+
+    // Server closes connections which stayed idle longer than its keep-alive timeout
+    if (host.inFlight == 0 && host.keepAliveTimeout >= 0 && host.lastActivity.isValid() && host.lastActivity.elapsed() > host.keepAliveTimeout) {
+        host.openConnections = 0;
     }
 
-    QCryptographicHash hash(QCryptographicHash::Md5);
-    hash.addData(sigParams + secret().toUtf8());
-    QString sig = hash.result().toHex();
-    postData.addQueryItem("sig", sig);
+    host.inFlight++;
+    if (host.inFlight > host.openConnections && host.openConnections < maxConnections) {
+        host.openConnections++;
+        _estimatedConnectionOpenCount++;
+    } else {
+        _estimatedConnectionReuseCount++;
+    }
 
-    //Define method url
-    QUrl pageUrl = QUrl("http://www.smoozik.com/index.php/api/" + method);
+    QNetworkReply *reply = post(smoozikReply->request(), smoozikReply->_data);
+    _inFlightHosts.insert(reply, key);
+    _networkReplies.insert(reply, smoozikReply);
+    smoozikReply->setNetworkReply(reply);
+    connect(reply, SIGNAL(finished()), this, SLOT(networkReplyFinished()));
+    connect(reply, SIGNAL(destroyed(QObject*)), this, SLOT(networkReplyDestroyed(QObject*)));
+}
 
-    //Encode data
-#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-    QByteArray encodedGetData = getData.encodedQuery().replace(QByteArray("+"), QByteArray("%2B"));
-    QByteArray encodedPostData = postData.encodedQuery().replace(QByteArray("+"), QByteArray("%2B"));
-#else
-    QByteArray encodedGetData = getData.query(QUrl::FullyEncoded).toUtf8().replace(QByteArray("+"), QByteArray("%2B"));
-    QByteArray encodedPostData = postData.query(QUrl::FullyEncoded).toUtf8().replace(QByteArray("+"), QByteArray("%2B"));
-#endif
+void SmoozikManager::releaseRequest(QObject *reply, bool connectionClosed)
+{
+    if (!_inFlightHosts.contains(reply)) {
+        return;
+    }
 
-    //Construct request
-    request.setUrl(pageUrl.toString() + "?" + encodedGetData);
+    QString key = _inFlightHosts.take(reply);
+    Host &host = _hosts[key];
+    host.inFlight--;
+    host.lastActivity.start();
+    if (connectionClosed && host.openConnections > 0) {
+        host.openConnections--;
+    }
 
-    QEventLoop loop;
-    connect(this, SIGNAL(finished(QNetworkReply*)), &loop, SLOT(quit()));
-    QNetworkReply *reply = post(request, encodedPostData);
-    if (blocking()) {
-        loop.exec();
+    processQueue(key);
+}
+
+void SmoozikManager::networkReplyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (!reply) {
+        return;
+    }
+
+    // Record how long the server keeps idle connections open, e.g. "Keep-Alive: timeout=5, max=100"
+    QString key = _inFlightHosts.value(reply);
+    QByteArray keepAlive = reply->rawHeader("Keep-Alive");
+    int timeoutIndex = keepAlive.indexOf("timeout=");
+    if (!key.isEmpty() && timeoutIndex >= 0) {
+        QByteArray timeout = keepAlive.mid(timeoutIndex + 8);
+        int end = timeout.indexOf(',');
+        if (end >= 0) {
+            timeout.truncate(end);
+        }
+        _hosts[key].keepAliveTimeout = timeout.trimmed().toInt() * 1000;
+    }
+
+    // Network layer and proxy errors drop the connection
+    bool networkError = reply->error() != QNetworkReply::NoError && reply->error() < QNetworkReply::ContentAccessDenied;
+    bool connectionClosed = networkError || reply->rawHeader("Connection").toLower() == "close";
+    SmoozikReply *smoozikReply = _networkReplies.take(reply);
+
+    // Requests aborted by the caller say nothing about the host, unlike requests which reached #timeout
+    bool canceled = reply->error() == QNetworkReply::OperationCanceledError;
+    bool timedOut = canceled && smoozikReply && smoozikReply->_timedOut;
+    bool failure = networkError && !canceled;
+
+    if (!key.isEmpty() && (!canceled || timedOut)) {
+        Host &host = _hosts[key];
+        if (!failure && !timedOut) {
+            host.failures = 0;
+            host.circuitOpen = false;
+        } else if (circuitBreakerThreshold() > 0 && ++host.failures >= circuitBreakerThreshold()) {
+            host.circuitOpen = true;
+            host.circuitOpenedAt.start();
+        }
+    }
+
+    releaseRequest(reply, connectionClosed);
+
+    if (smoozikReply && !smoozikReply->isFinished() && smoozikReply->_networkReply == reply) {
+        // Requests which already received data are not retried as the server processed them
+        if (failure && !smoozikReply->hasReceivedData() && smoozikReply->retryCount() < maxRetries(smoozikReply->method())) {
+            smoozikReply->_networkReply = 0;
+            QTimer *timer = new QTimer(smoozikReply);
+            timer->setSingleShot(true);
+            connect(timer, SIGNAL(timeout()), this, SLOT(retryTimeout()));
+            timer->start(nextRetryDelay(smoozikReply->_retryCount++));
+        } else if (!smoozikReply->_cacheKey.isEmpty()) {
+            QHash<QByteArray, CacheEntry>::iterator i = _cache.find(smoozikReply->_cacheKey);
+            if (i != _cache.end() && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+                i.value().storedAt.start();
+                i.value().revalidating = false;
+                _notModifiedCount++;
+                smoozikReply->completeFrom(i.value().reply);
+            } else {
+                if (i != _cache.end()) {
+                    i.value().revalidating = false;
+                }
+                // The reply may be deleted by a slot connected to finished()
+                QPointer<SmoozikReply> guard(smoozikReply);
+                smoozikReply->complete(reply);
+                if (guard) {
+                    cacheReply(smoozikReply);
+                }
+            }
+        } else {
+            smoozikReply->complete(reply);
+        }
+    }
+    reply->deleteLater();
+}
+
+void SmoozikManager::retryTimeout()
+{
+    QTimer *timer = qobject_cast<QTimer *>(sender());
+    if (!timer) {
+        return;
+    }
+
+    SmoozikReply *smoozikReply = qobject_cast<SmoozikReply *>(timer->parent());
+    timer->deleteLater();
+    if (smoozikReply && !smoozikReply->isFinished()) {
+        enqueueRequest(smoozikReply);
+    }
+}
+
+void SmoozikManager::stagedReplyDestroyed()
+{
+    // QPointer to the deleted reply is already null, so the stage may now be over
+    if (!_stages.isEmpty()) {
+        processStages();
+    }
+}
+
+void SmoozikManager::networkReplyDestroyed(QObject *reply)
+{
+    _networkReplies.remove(reply);
+    releaseRequest(reply, true);
+}
+
+void SmoozikManager::smoozikReplyFinished()
+{
+    SmoozikReply *smoozikReply = qobject_cast<SmoozikReply *>(sender());
+    if (!smoozikReply) {
+        return;
+    }
+
+    // Identical requests get the result of this one, unless it was aborted
+    if (_pendingReadKeys.contains(smoozikReply)) {
+        QByteArray key = _pendingReadKeys.take(smoozikReply);
+        QList<QPointer<SmoozikReply> > followers = _pendingReads.take(key).followers;
+
+        if (smoozikReply->error() == QNetworkReply::OperationCanceledError) {
+            promoteFollower(key, followers);
+        } else {
+            foreach(const QPointer<SmoozikReply> &follower, followers) {
+                if (follower && !follower->isFinished()) {
+                    follower->completeFrom(smoozikReply);
+                }
+            }
+        }
+    }
+
+    if (!isReadOnly(smoozikReply->method())) {
+        invalidateCache();
+    }
+
+    emit requestFinished(smoozikReply);
+
+    if (!_stages.isEmpty()) {
+        processStages();
     }
-    return reply;
 }
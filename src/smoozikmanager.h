@@ -25,9 +25,15 @@
 #include <QNetworkReply>
 #include <QTimer>
 #include <QTime>
+#include <QElapsedTimer>
+#include <QDateTime>
 #include <QEventLoop>
 #include <QDebug>
 #include <QMap>
+#include <QHash>
+#include <QQueue>
+#include <QSet>
+#include <QPointer>
 #include <QStringList>
 #include <QCryptographicHash>
 #include <QDomDocument>
@@ -39,6 +45,10 @@
 #include "global.h"
 #include "smooziktrack.h"
 #include "smoozikplaylist.h"
+#include "smoozikplaylistdelta.h"
+#include "smoozikplaylistview.h"
+#include "smoozikreply.h"
+#include "smoozikrequestencoder.h"
 
 /**
  * @brief The SmoozikManager class is a Network Access Manager designed to send request to Smoozik server.
@@ -88,6 +98,164 @@ class SMOOZIKLIB_EXPORT SmoozikManager : public QNetworkAccessManager
      * @pm _blocking
      */
     Q_PROPERTY(bool blocking READ blocking WRITE setBlocking)
+    /**
+     * @brief This property holds the maximum time in milliseconds a blocking request waits for the server.
+     *
+     * Once this deadline is reached, the request is aborted and its reply finishes with QNetworkReply::OperationCanceledError.
+     * A negative value means blocking requests wait without deadline. Default is -1.
+     * @af timeout(), setTimeout()
+     * @pm _timeout
+     */
+    Q_PROPERTY(int timeout READ timeout WRITE setTimeout)
+    /**
+     * @brief This property holds the url of Smoozik API. Method names are appended to it to build endpoints.
+     *
+     * Set it to send requests to a local proxy or test server. Default is http://www.smoozik.com/index.php/api/.
+     * @af baseUrl(), setBaseUrl()
+     * @pm _baseUrl
+     * @sa setEndpoint()
+     */
+    Q_PROPERTY(QUrl baseUrl READ baseUrl WRITE setBaseUrl)
+    /**
+     * @brief This property holds wether requests built from #baseUrl are sent with HTTPS.
+     *
+     * Endpoints set with setEndpoint() keep their own scheme. Default is false.
+     * @af secure(), setSecure()
+     * @pm _secure
+     */
+    Q_PROPERTY(bool secure READ secure WRITE setSecure)
+    /**
+     * @brief This property holds the maximum number of requests in flight at the same time towards a same host.
+     *
+     * Requests sent beyond this limit are queued and sent, in order, as soon as a request to the same host finishes.
+     * Connections are kept alive between requests so that queued requests reuse them.
+     * A value lower than 1 means no limit. Default is 6, which is the number of connections Qt opens to a same host.
+     * @af maxRequestsPerHost(), setMaxRequestsPerHost()
+     * @pm _maxRequestsPerHost
+     */
+    Q_PROPERTY(int maxRequestsPerHost READ maxRequestsPerHost WRITE setMaxRequestsPerHost)
+    /**
+     * @brief This property holds the time in milliseconds during which requests are collected in a batch before being sent.
+     *
+     * Batching is useful for bursts of non-blocking requests, such as setTrack() followed by getTopTracks().
+     * The window opens with the first request of a batch. When it closes, or when #batchSize requests are collected, all requests of the batch are sent together
+     * over kept-alive connections, with HTTP pipelining allowed. Every request still gets its own reply.
+     * Requests of a batch are sent in stages to keep their order: consecutive requests of the same kind (read-only or not) are sent at once,
+     * and a stage is only sent once the previous one is finished. See setReadOnly().
+     * Blocking requests do not benefit from batching as each of them waits for its own reply.
+     * A value lower than 1 disables batching. Default is 0.
+     * @af batchInterval(), setBatchInterval()
+     * @pm _batchInterval
+     */
+    Q_PROPERTY(int batchInterval READ batchInterval WRITE setBatchInterval)
+    /**
+     * @brief This property holds the size in bytes above which POST data is sent compressed.
+     *
+     * Compressed data is sent in zlib format with a "Content-Encoding: deflate" header, only if it is smaller than the original data.
+     * The server must accept compressed requests. A negative value disables compression. Default is -1.
+     * @af compressionThreshold(), setCompressionThreshold()
+     * @pm _compressionThreshold
+     */
+    Q_PROPERTY(int compressionThreshold READ compressionThreshold WRITE setCompressionThreshold)
+    /**
+     * @brief This property holds wether compressed responses are requested.
+     *
+     * If true, requests are sent with an "Accept-Encoding: deflate" header and compressed responses are decompressed by SmoozikReply before being read.
+     * If false, Qt negotiates the encoding of responses itself. Default is false.
+     * @af acceptCompressedResponses(), setAcceptCompressedResponses()
+     * @pm _acceptCompressedResponses
+     */
+    Q_PROPERTY(bool acceptCompressedResponses READ acceptCompressedResponses WRITE setAcceptCompressedResponses)
+    /**
+     * @brief This property holds the maximum number of requests in a batch.
+     *
+     * A batch is sent as soon as it holds this number of requests, even if #batchInterval is not over. Default is 10.
+     * @af batchSize(), setBatchSize()
+     * @pm _batchSize
+     */
+    Q_PROPERTY(int batchSize READ batchSize WRITE setBatchSize)
+    /**
+     * @brief This property holds the maximum number of times a request to an idempotent method is sent again after a network failure.
+     *
+     * Only failures which happened before any data was received are retried. Requests to methods which are not idempotent, which is the default, are never retried.
+     * Default is 3.
+     * @af maxRetries(), setMaxRetries()
+     * @pm _maxRetries
+     * @sa setIdempotent()
+     */
+    Q_PROPERTY(int maxRetries READ maxRetries WRITE setMaxRetries)
+    /**
+     * @brief This property holds the time in milliseconds during which responses to read-only methods are served from cache.
+     *
+     * A cached response younger than this time is returned without contacting the server. Once it is older, the request is sent with If-None-Match and If-Modified-Since headers
+     * so that the server only answers "304 Not Modified" if the response did not change.
+     * Requests to methods which are not read-only empty the cache when they are sent and when they finish. See also invalidateCache().
+     * A value lower than 1 disables the cache. Default is 0.
+     * @af cacheTtl(), setCacheTtl()
+     * @pm _cacheTtl
+     * @sa setReadOnly()
+     */
+    Q_PROPERTY(int cacheTtl READ cacheTtl WRITE setCacheTtl)
+    /**
+     * @brief This property holds the time in milliseconds after #cacheTtl during which a cached response is still served while it is revalidated in the background.
+     *
+     * Default is 0.
+     * @af staleWhileRevalidate(), setStaleWhileRevalidate()
+     * @pm _staleWhileRevalidate
+     */
+    Q_PROPERTY(int staleWhileRevalidate READ staleWhileRevalidate WRITE setStaleWhileRevalidate)
+    /**
+     * @brief This property holds wether identical read-only requests share the same server request.
+     *
+     * A request to a read-only method with the same parameters as a request already in flight is not sent: its reply finishes with the result of the request in flight.
+     * Every caller still gets its own SmoozikReply. If the request in flight is aborted or deleted, one of the waiting requests is sent instead.
+     * Default is true.
+     * @af deduplicateReads(), setDeduplicateReads()
+     * @pm _deduplicateReads
+     * @sa setReadOnly()
+     */
+    Q_PROPERTY(bool deduplicateReads READ deduplicateReads WRITE setDeduplicateReads)
+    /**
+     * @brief This property holds the delay in milliseconds before the first retry of a request.
+     *
+     * The delay doubles with each retry up to #maxRetryDelay. A random jitter of up to half the delay is removed so that clients do not retry in lockstep after an outage.
+     * Default is 500.
+     * @af retryDelay(), setRetryDelay()
+     * @pm _retryDelay
+     */
+    Q_PROPERTY(int retryDelay READ retryDelay WRITE setRetryDelay)
+    /**
+     * @brief This property holds the maximum delay in milliseconds before a retry. Default is 30000.
+     * @af maxRetryDelay(), setMaxRetryDelay()
+     * @pm _maxRetryDelay
+     */
+    Q_PROPERTY(int maxRetryDelay READ maxRetryDelay WRITE setMaxRetryDelay)
+    /**
+     * @brief This property holds the number of consecutive network failures towards a host after which requests to that host fail fast.
+     *
+     * While the circuit is open, requests to the host finish immediately with QNetworkReply::TemporaryNetworkFailureError, without being sent.
+     * Blocking requests aborted because they reached #timeout count as failures, requests aborted by the caller do not.
+     * Once #circuitBreakerTimeout is over, a single request is sent to probe the server: the circuit closes if it gets an answer and opens again otherwise.
+     * A value lower than 1 disables the circuit breaker. Default is 5.
+     * @af circuitBreakerThreshold(), setCircuitBreakerThreshold()
+     * @pm _circuitBreakerThreshold
+     */
+    Q_PROPERTY(int circuitBreakerThreshold READ circuitBreakerThreshold WRITE setCircuitBreakerThreshold)
+    /**
+     * @brief This property holds the time in milliseconds during which an open circuit fails requests fast. Default is 30000.
+     * @af circuitBreakerTimeout(), setCircuitBreakerTimeout()
+     * @pm _circuitBreakerTimeout
+     */
+    Q_PROPERTY(int circuitBreakerTimeout READ circuitBreakerTimeout WRITE setCircuitBreakerTimeout)
+    /**
+     * @brief This property holds the size of a playlist delta, in percent of the playlist size, above which updatePlaylist() sends the whole playlist.
+     *
+     * Sending the whole playlist is simpler for the server once most tracks have changed. A negative value always sends the whole playlist.
+     * Default is -1: deltas are only sent once this property is set, to a server known to implement the updatePlaylist method.
+     * @af playlistDeltaThreshold(), setPlaylistDeltaThreshold()
+     * @pm _playlistDeltaThreshold
+     */
+    Q_PROPERTY(int playlistDeltaThreshold READ playlistDeltaThreshold WRITE setPlaylistDeltaThreshold)
     Q_ENUMS(Error)
 
 public:
@@ -173,6 +341,296 @@ public:
         _blocking = blocking;
     } /**< @see #blocking */
 
+    inline int timeout() const {
+        return _timeout;
+    } /**< @see #timeout */
+
+    inline void setTimeout(int timeout) {
+        _timeout = timeout;
+    } /**< @see #timeout */
+
+    inline QUrl baseUrl() const {
+        return _baseUrl;
+    } /**< @see #baseUrl */
+
+    /**
+     * @see #baseUrl
+     *
+     * A trailing slash is added to the path if missing.
+     */
+    void setBaseUrl(const QUrl &baseUrl);
+
+    inline bool secure() const {
+        return _secure;
+    } /**< @see #secure */
+
+    void setSecure(bool secure); /**< @see #secure */
+
+    /**
+     * @brief Returns the url requests for @em method are sent to.
+     *
+     * Endpoints are built once per method and cached.
+     */
+    QUrl endpoint(const QString &method) const;
+
+    /**
+     * @brief Sends requests for @em method to @em url instead of the url built from #baseUrl.
+     *
+     * An invalid @em url removes the override.
+     */
+    void setEndpoint(const QString &method, const QUrl &url);
+
+    inline int maxRequestsPerHost() const {
+        return _maxRequestsPerHost;
+    } /**< @see #maxRequestsPerHost */
+
+    /**
+     * @see #maxRequestsPerHost
+     *
+     * Raising the limit sends queued requests immediately.
+     */
+    void setMaxRequestsPerHost(int maxRequestsPerHost);
+
+    inline int compressionThreshold() const {
+        return _compressionThreshold;
+    } /**< @see #compressionThreshold */
+
+    inline void setCompressionThreshold(int compressionThreshold) {
+        _compressionThreshold = compressionThreshold;
+    } /**< @see #compressionThreshold */
+
+    inline bool acceptCompressedResponses() const {
+        return _acceptCompressedResponses;
+    } /**< @see #acceptCompressedResponses */
+
+    inline void setAcceptCompressedResponses(bool acceptCompressedResponses) {
+        _acceptCompressedResponses = acceptCompressedResponses;
+    } /**< @see #acceptCompressedResponses */
+
+    inline int batchInterval() const {
+        return _batchInterval;
+    } /**< @see #batchInterval */
+
+    /**
+     * @see #batchInterval
+     *
+     * Disabling batching sends the current batch immediately.
+     */
+    void setBatchInterval(int batchInterval);
+
+    inline int batchSize() const {
+        return _batchSize;
+    } /**< @see #batchSize */
+
+    inline void setBatchSize(int batchSize) {
+        _batchSize = batchSize;
+    } /**< @see #batchSize */
+
+    /**
+     * @brief Returns true if @em method only reads data from Smoozik server.
+     *
+     * By default, only getTopTracks is read-only.
+     */
+    inline bool isReadOnly(const QString &method) const {
+        return _readOnlyMethods.contains(method);
+    }
+
+    /**
+     * @brief Declares whether @em method only reads data from Smoozik server.
+     */
+    void setReadOnly(const QString &method, bool readOnly = true);
+
+    inline bool deduplicateReads() const {
+        return _deduplicateReads;
+    } /**< @see #deduplicateReads */
+
+    inline void setDeduplicateReads(bool deduplicateReads) {
+        _deduplicateReads = deduplicateReads;
+    } /**< @see #deduplicateReads */
+
+    inline int cacheTtl() const {
+        return _cacheTtl;
+    } /**< @see #cacheTtl */
+
+    inline void setCacheTtl(int cacheTtl) {
+        _cacheTtl = cacheTtl;
+    } /**< @see #cacheTtl */
+
+    /**
+     * @brief Returns the cache time to live of responses to @em method.
+     *
+     * It is 0 for methods which are not read-only, the value set with setCacheTtl(const QString &, int) if any, and #cacheTtl otherwise.
+     */
+    int cacheTtl(const QString &method) const;
+
+    /**
+     * @brief Sets the cache time to live of responses to read-only @em method, overriding #cacheTtl. A negative value removes the override.
+     */
+    void setCacheTtl(const QString &method, int cacheTtl);
+
+    inline int staleWhileRevalidate() const {
+        return _staleWhileRevalidate;
+    } /**< @see #staleWhileRevalidate */
+
+    inline void setStaleWhileRevalidate(int staleWhileRevalidate) {
+        _staleWhileRevalidate = staleWhileRevalidate;
+    } /**< @see #staleWhileRevalidate */
+
+    /**
+     * @brief Removes all cached responses.
+     * @see #cacheTtl
+     */
+    void invalidateCache();
+
+    /**
+     * @brief Removes cached responses to @em method.
+     */
+    void invalidateCache(const QString &method);
+
+    inline int maxRetries() const {
+        return _maxRetries;
+    } /**< @see #maxRetries */
+
+    inline void setMaxRetries(int maxRetries) {
+        _maxRetries = maxRetries;
+    } /**< @see #maxRetries */
+
+    /**
+     * @brief Returns the maximum number of retries of requests to @em method.
+     *
+     * It is 0 for methods which are not idempotent, the value set with setMaxRetries(const QString &, int) if any, and #maxRetries otherwise.
+     */
+    int maxRetries(const QString &method) const;
+
+    /**
+     * @brief Sets the maximum number of retries of requests to idempotent @em method, overriding #maxRetries. A negative value removes the override.
+     */
+    void setMaxRetries(const QString &method, int maxRetries);
+
+    /**
+     * @brief Returns true if requests to @em method can safely be sent several times.
+     *
+     * Methods are not idempotent unless declared so with setIdempotent(), as a request which failed may still have been processed by the server.
+     * By default, only getTopTracks is idempotent.
+     */
+    inline bool isIdempotent(const QString &method) const {
+        return _idempotentMethods.contains(method);
+    }
+
+    /**
+     * @brief Declares whether requests to @em method can safely be sent several times.
+     */
+    void setIdempotent(const QString &method, bool idempotent = true);
+
+    inline int retryDelay() const {
+        return _retryDelay;
+    } /**< @see #retryDelay */
+
+    inline void setRetryDelay(int retryDelay) {
+        _retryDelay = retryDelay;
+    } /**< @see #retryDelay */
+
+    inline int maxRetryDelay() const {
+        return _maxRetryDelay;
+    } /**< @see #maxRetryDelay */
+
+    inline void setMaxRetryDelay(int maxRetryDelay) {
+        _maxRetryDelay = maxRetryDelay;
+    } /**< @see #maxRetryDelay */
+
+    inline int circuitBreakerThreshold() const {
+        return _circuitBreakerThreshold;
+    } /**< @see #circuitBreakerThreshold */
+
+    inline void setCircuitBreakerThreshold(int circuitBreakerThreshold) {
+        _circuitBreakerThreshold = circuitBreakerThreshold;
+    } /**< @see #circuitBreakerThreshold */
+
+    inline int circuitBreakerTimeout() const {
+        return _circuitBreakerTimeout;
+    } /**< @see #circuitBreakerTimeout */
+
+    inline void setCircuitBreakerTimeout(int circuitBreakerTimeout) {
+        _circuitBreakerTimeout = circuitBreakerTimeout;
+    } /**< @see #circuitBreakerTimeout */
+
+    inline int playlistDeltaThreshold() const {
+        return _playlistDeltaThreshold;
+    } /**< @see #playlistDeltaThreshold */
+
+    inline void setPlaylistDeltaThreshold(int playlistDeltaThreshold) {
+        _playlistDeltaThreshold = playlistDeltaThreshold;
+    } /**< @see #playlistDeltaThreshold */
+
+    /**
+     * @brief Returns true if requests to @em method currently fail fast because its server is unreachable.
+     * @see #circuitBreakerThreshold
+     */
+    bool isCircuitOpen(const QString &method) const;
+
+    /**
+     * @name Connection statistics
+     *
+     * Qt does not tell which connection serves a request, so connection counts are estimates, not measurements.
+     * The manager models the connections to each host: a request sent while all connections believed open are busy is assumed to open a new one,
+     * up to the 6 connections Qt opens to a same host, and any other request is assumed to reuse an idle kept-alive connection.
+     * Connections are believed closed when the server asks for it, when a network error occurs
+     * or when they stay idle longer than the keep-alive timeout announced by the server.
+     */
+    //@{
+    /**
+     * @brief Returns the estimated number of requests which opened a new connection.
+     */
+    inline int estimatedConnectionOpenCount() const {
+        return _estimatedConnectionOpenCount;
+    }
+
+    /**
+     * @brief Returns the estimated number of requests which reused a kept-alive connection.
+     */
+    inline int estimatedConnectionReuseCount() const {
+        return _estimatedConnectionReuseCount;
+    }
+
+    /**
+     * @brief Resets estimatedConnectionOpenCount(), estimatedConnectionReuseCount(), deduplicatedRequestCount(), cacheHitCount() and notModifiedCount() to 0.
+     */
+    void resetConnectionStatistics();
+
+    /**
+     * @brief Returns the number of requests which were not sent as an identical request was in flight.
+     * @see #deduplicateReads
+     */
+    inline int deduplicatedRequestCount() const {
+        return _deduplicatedRequestCount;
+    }
+
+    /**
+     * @brief Returns the number of requests answered from cache, without contacting the server.
+     * @see #cacheTtl
+     */
+    inline int cacheHitCount() const {
+        return _cacheHitCount;
+    }
+
+    /**
+     * @brief Returns the number of requests answered from cache after the server answered "304 Not Modified".
+     */
+    inline int notModifiedCount() const {
+        return _notModifiedCount;
+    }
+
+    /**
+     * @brief Returns the number of requests currently in flight.
+     */
+    int inFlightRequestCount() const;
+
+    /**
+     * @brief Returns the number of requests waiting for a free slot to be sent.
+     */
+    int queuedRequestCount() const;
+    //@}
+
     /**
      * @name API Methods
      */
@@ -215,7 +673,18 @@ public:
      * @rights Managers only
      */
     inline QNetworkReply *setTrack(const SmoozikTrack *track, int position = 0) {
-        return setTrack(track->localId(), track->name(), track->artist(), track->album(), track->duration(), position);
+        return setTrack(track->data(), position);
+    }
+
+    /**
+     * @brief Sets a track for the party.
+     *
+     * @param track Track to set
+     * @param position Position of the track in playlist
+     * @rights Managers only
+     */
+    inline QNetworkReply *setTrack(const SmoozikTrackData &track, int position = 0) {
+        return setTrack(track.localId(), track.name(), track.artist(), track.album(), track.duration(), position);
     }
 
     /**
@@ -243,6 +712,17 @@ public:
         return unsetTrack(track->localId());
     }
 
+    /**
+     * @brief Unsets this track as currently playing or coming for the party.
+     *
+     * If a track has been set as current or coming with setTrack(), this function can be used to unset it.
+     * @param track Track to unset
+     * @rights Managers only
+     */
+    inline QNetworkReply *unsetTrack(const SmoozikTrackData &track) {
+        return unsetTrack(track.localId());
+    }
+
     /**
      * @brief Unsets this track as currently playing or coming for the party.
      *
@@ -267,6 +747,27 @@ public:
      */
     QNetworkReply *sendPlaylist(const SmoozikPlaylist *playlist);
 
+    /**
+     * @brief Sends the playlist made of the tracks of view @em playlist.
+     * @param playlist Playlist to send
+     * @rights Managers only
+     */
+    QNetworkReply *sendPlaylist(const SmoozikPlaylistView *playlist);
+
+    /**
+     * @brief Sends the changes from playlist @em previous, already sent, to playlist @em playlist.
+     *
+     * Only added and changed tracks, and localIds of removed tracks, are sent with the updatePlaylist method (see SmoozikPlaylistDelta).
+     * If @em previous is null, if #playlistDeltaThreshold is negative, which is the default, or if the delta is larger than #playlistDeltaThreshold,
+     * @em playlist is sent with sendPlaylist() instead.
+     * @param previous Playlist last sent to the server
+     * @param playlist New playlist
+     * @return The reply of the request, or 0 if deltas are enabled and nothing changed since @em previous, in which case no request is sent.
+     * Unlike other request methods, callers must thus check the returned pointer before connecting to it.
+     * @rights Managers only
+     */
+    QNetworkReply *updatePlaylist(const SmoozikPlaylist *previous, const SmoozikPlaylist *playlist);
+
     /**
      * @brief Forces disconnection of users which have not touched the party since more than @em lastTouchDelay seconds.
      * @rights Managers only
@@ -276,23 +777,315 @@ public:
 
     /**
      * @brief Sends a signed request to Smoozik server using #apiKey and #sessionKey with #format.
+     *
+     * If #blocking is true, this function returns once the reply is finished or #timeout is reached.
      * @param method The requested methods
      * @param getParams Parameters sent through GET method
      * @param postParams Parameters sent through POST method
      * @return Reply of the server
+     * @sa send()
      */
     virtual QNetworkReply *request(const QString &method, QMap<QString, QString> getParams = QMap<QString, QString>(), QMap<QString, QString> postParams = QMap<QString, QString>());
 
+    /**
+     * @brief Sends a signed request to Smoozik server using #apiKey and #sessionKey with #format and returns immediately, regardless of #blocking.
+     *
+     * Use SmoozikReply::finished() to be notified of completion, or SmoozikReply::waitForFinished() to wait for this request only.
+     * The returned reply is a child of the manager; it should be deleted with deleteLater() once processed (SmoozikXml::parse() does it).
+     * @param method The requested methods
+     * @param getParams Parameters sent through GET method
+     * @param postParams Parameters sent through POST method
+     * @return Handle of the request
+     */
+    SmoozikReply *send(const QString &method, const QMap<QString, QString> &getParams = QMap<QString, QString>(), const QMap<QString, QString> &postParams = QMap<QString, QString>());
+
 private:
+    /**
+     * @brief Initializes the manager with default settings. Shared by constructors.
+     */
+    void init(const QString &apiKey, const QString &secret, const SmoozikManager::Format &format, bool blocking);
+
     QString _apiKey; /**< @see #apiKey */
     QString _secret; /**< @see #secret */
     QString _sessionKey; /**< @see #sessionKey */
     Format _format; /**< @see #format */
     bool _blocking; /**< @see #blocking */
+    int _timeout; /**< @see #timeout */
+    int _maxRequestsPerHost; /**< @see #maxRequestsPerHost */
+    QUrl _baseUrl; /**< @see #baseUrl */
+    bool _secure; /**< @see #secure */
+    int _cacheTtl; /**< @see #cacheTtl */
+    int _staleWhileRevalidate; /**< @see #staleWhileRevalidate */
+    int _cacheHitCount; /**< @see cacheHitCount() */
+    int _notModifiedCount; /**< @see notModifiedCount() */
+    bool _deduplicateReads; /**< @see #deduplicateReads */
+    int _deduplicatedRequestCount; /**< @see deduplicatedRequestCount() */
+    int _maxRetries; /**< @see #maxRetries */
+    int _retryDelay; /**< @see #retryDelay */
+    int _maxRetryDelay; /**< @see #maxRetryDelay */
+    int _circuitBreakerThreshold; /**< @see #circuitBreakerThreshold */
+    int _circuitBreakerTimeout; /**< @see #circuitBreakerTimeout */
+    int _playlistDeltaThreshold; /**< @see #playlistDeltaThreshold */
+    int _compressionThreshold; /**< @see #compressionThreshold */
+    bool _acceptCompressedResponses; /**< @see #acceptCompressedResponses */
+    int _batchInterval; /**< @see #batchInterval */
+    int _batchSize; /**< @see #batchSize */
+    int _estimatedConnectionOpenCount; /**< @see estimatedConnectionOpenCount() */
+    int _estimatedConnectionReuseCount; /**< @see estimatedConnectionReuseCount() */
+
+    /**
+     * @brief The Host struct holds the state of requests and connections towards a host.
+     */
+    struct Host {
+        Host() : inFlight(0), openConnections(0), keepAliveTimeout(-1), failures(0), circuitOpen(false) {}
+        int inFlight; /**< Number of requests in flight */
+        int openConnections; /**< Number of connections believed open */
+        int keepAliveTimeout; /**< Idle time in milliseconds after which the server closes connections, -1 if unknown */
+        QElapsedTimer lastActivity; /**< Time at which the last request finished */
+        int failures; /**< Number of consecutive network failures */
+        bool circuitOpen; /**< True if requests fail fast, see #circuitBreakerThreshold */
+        QElapsedTimer circuitOpenedAt; /**< Time at which the circuit opened */
+        QQueue<QPointer<SmoozikReply> > queue; /**< Requests waiting to be sent */
+    };
+
+    /**
+     * @brief This property holds the state of each host, indexed by hostKey().
+     */
+    QHash<QString, Host> _hosts;
+
+    /**
+     * @brief This property holds the key of the host of each network reply in flight.
+     */
+    QHash<QObject *, QString> _inFlightHosts;
+
+    /**
+     * @brief This property holds the SmoozikReply served by each network reply in flight.
+     */
+    QHash<QObject *, QPointer<SmoozikReply> > _networkReplies;
+
+    /**
+     * @brief The CacheEntry struct holds a cached response.
+     */
+    struct CacheEntry {
+        CacheEntry() : reply(0), revalidating(false) {}
+        SmoozikReply *reply; /**< Finished copy of the response, owned by the manager */
+        QElapsedTimer storedAt; /**< Time at which the response was received or revalidated */
+        bool revalidating; /**< True while a background revalidation is in flight */
+    };
+
+    /**
+     * @brief This property holds cached responses, indexed by method, url and unsigned POST data.
+     */
+    QHash<QByteArray, CacheEntry> _cache;
+
+    /**
+     * @brief This property holds the cache time to live by method.
+     * @see cacheTtl(const QString &)
+     */
+    QHash<QString, int> _methodCacheTtls;
+
+    /**
+     * @brief Stores a copy of @em smoozikReply in cache if it is a successful response.
+     */
+    void cacheReply(SmoozikReply *smoozikReply);
+
+    /**
+     * @brief Adds If-None-Match and If-Modified-Since headers matching @em entry to @em request.
+     */
+    static void setConditionalHeaders(QNetworkRequest *request, const CacheEntry &entry);
+
+    /**
+     * @brief The PendingRead struct holds a read-only request in flight and the identical requests waiting for its result.
+     */
+    struct PendingRead {
+        QPointer<SmoozikReply> leader; /**< Request sent to the server */
+        QList<QPointer<SmoozikReply> > followers; /**< Requests finished with the result of #leader */
+    };
+
+    /**
+     * @brief This property holds read-only requests in flight, indexed by method, url and unsigned POST data.
+     */
+    QHash<QByteArray, PendingRead> _pendingReads;
+
+    /**
+     * @brief This property holds the key in #_pendingReads of each leading request.
+     */
+    QHash<QObject *, QByteArray> _pendingReadKeys;
+
+    /**
+     * @brief Sends the first unfinished request of @em followers in place of a leader which will not complete, the others wait for it.
+     */
+    void promoteFollower(const QByteArray &key, const QList<QPointer<SmoozikReply> > &followers);
+
+    /**
+     * @brief Registers @em smoozikReply as the request in flight for @em key.
+     */
+    void setPendingRead(const QByteArray &key, SmoozikReply *smoozikReply, const QList<QPointer<SmoozikReply> > &followers);
+
+    /**
+     * @brief This property holds the maximum number of retries by method.
+     * @see maxRetries(const QString &)
+     */
+    QHash<QString, int> _methodMaxRetries;
+
+    /**
+     * @brief This property holds the methods which are idempotent.
+     * @see isIdempotent()
+     */
+    QSet<QString> _idempotentMethods;
+
+    /**
+     * @brief This property holds the state of the random generator used for retry jitter.
+     */
+    quint32 _randomState;
+
+    /**
+     * @brief Returns the delay in milliseconds before retry number @em retry (starting at 0), jitter included.
+     */
+    int nextRetryDelay(int retry);
+
+    /**
+     * @brief The Endpoint struct holds the url of a method.
+     */
+    struct Endpoint {
+        QUrl url; /**< @brief Url requests are sent to, without query. */
+        bool overridden; /**< @brief True if set with setEndpoint(), false if built from #baseUrl. */
+    };
+
+    /**
+     * @brief This property holds endpoints by method.
+     * @see endpoint()
+     */
+    mutable QHash<QString, Endpoint> _endpoints;
+
+    /**
+     * @brief Removes cached endpoints built from #baseUrl.
+     */
+    void clearEndpoints();
+
+    /**
+     * @brief This property holds the encoder signing requests. It is reused to keep its buffers between requests.
+     */
+    mutable SmoozikRequestEncoder _encoder;
+
+    /**
+     * @brief This property holds the methods which only read data.
+     * @see isReadOnly()
+     */
+    QSet<QString> _readOnlyMethods;
+
+    /**
+     * @brief This property holds the requests collected in the current batch.
+     */
+    QList<QPointer<SmoozikReply> > _batch;
+
+    /**
+     * @brief This property holds the timer closing the batch window.
+     */
+    QTimer _batchTimer;
+
+    /**
+     * @brief This property holds the stages of flushed batches. The first stage is the one being sent.
+     */
+    QList<QList<QPointer<SmoozikReply> > > _stages;
+
+    /**
+     * @brief This property holds whether the first stage of #_stages has been sent.
+     */
+    bool _stageSent;
+
+    /**
+     * @brief Sends the first stage of #_stages once the previous one is finished.
+     */
+    void processStages();
+
+    /**
+     * @brief Returns the key identifying the host of @em url (scheme, host and port).
+     */
+    static QString hostKey(const QUrl &url);
+
+    /**
+     * @brief Signs and encodes parameters of @em method.
+     * @param method The requested methods
+     * @param getParams Parameters sent through GET method
+     * @param postParams Parameters sent through POST method
+     * @param request Request to fill with url and headers
+     * @param postData Encoded POST data
+     */
+    void prepareRequest(const QString &method, const QMap<QString, QString> &getParams, const QMap<QString, QString> &postParams, QNetworkRequest *request, QByteArray *postData) const;
+
+    /**
+     * @brief Queues @em smoozikReply behind requests to the same host and sends what #maxRequestsPerHost allows.
+     */
+    void enqueueRequest(SmoozikReply *smoozikReply);
+
+    /**
+     * @brief Sends queued requests to host @em key while #maxRequestsPerHost allows.
+     */
+    void processQueue(const QString &key);
+
+    /**
+     * @brief Posts the request held by @em smoozikReply on the network.
+     */
+    void startRequest(SmoozikReply *smoozikReply, const QString &key);
+
+    /**
+     * @brief Releases the slot held by network reply @em reply and sends next queued requests.
+     * @param reply Network reply which finished or was destroyed
+     * @param connectionClosed Whether the connection used by @em reply should be considered closed
+     */
+    void releaseRequest(QObject *reply, bool connectionClosed);
+
+protected:
+    /**
+     * @brief Builds the url of @em method from #baseUrl and #secure.
+     *
+     * Reimplement this function to compute endpoints differently. It is called once per method, until #baseUrl or #secure changes.
+     */
+    virtual QUrl createEndpoint(const QString &method) const;
+
+public slots:
+    /**
+     * @brief Sends the current batch without waiting for the end of #batchInterval.
+     */
+    void flushBatch();
+
+private slots:
+    /**
+     * @brief Forwards the result of a finished network reply to its SmoozikReply.
+     */
+    void networkReplyFinished();
+
+    /**
+     * @brief Releases the slot of a network reply destroyed before it finished.
+     */
+    void networkReplyDestroyed(QObject *reply);
+
+    /**
+     * @brief Emits #requestFinished() for the SmoozikReply which sent the signal.
+     */
+    void smoozikReplyFinished();
+
+    /**
+     * @brief Sends again the SmoozikReply parent of the retry timer which sent the signal.
+     */
+    void retryTimeout();
+
+    /**
+     * @brief Sends the next stage of #_stages if the batched SmoozikReply deleted before it finished was the last one of its stage.
+     */
+    void stagedReplyDestroyed();
+
+    /**
+     * @brief Hands identical requests waiting for a leading request deleted before it finished to another leader.
+     */
+    void pendingReadDestroyed(QObject *smoozikReply);
 
 signals:
     /**
-     * @brief This signal is emitted when the request is finished.
+     * @brief This signal is emitted when a request sent with request() or send() is finished.
+     *
+     * Contrary to QNetworkAccessManager::finished(), @em reply is the reply returned by request() or send().
      * @param reply The network reply
      */
     void requestFinished(QNetworkReply *reply);
@@ -20,6 +20,8 @@
 
 #include "smoozikplaylist.h"
 #include "smoozikxml.h"
+#include "smoozikjson.h"
+#include "smoozikplaylistsnapshot.h"
 
 SmoozikPlaylist::SmoozikPlaylist(QObject *parent) :
     QObject(parent)
@@ -43,10 +45,56 @@ SmoozikPlaylist::~SmoozikPlaylist()
 
 }
 
+SmoozikPlaylist *SmoozikPlaylist::fromReply(QNetworkReply *reply, QObject *parent)
+{
+    QByteArray data = reply->readAll();
+    reply->deleteLater();
+
+    // Responses in SmoozikManager::JSON format are objects
+    int i = 0;
+    while (i < data.size() && QChar(data.at(i)).isSpace()) {
+        i++;
+    }
+    if (i < data.size() && data.at(i) == '{') {
+        SmoozikJson json;
+        return json.parseTracks(data, parent);
+    }
+    SmoozikXml xml;
+    return xml.parseTracks(data, parent);
+}
+
+SmoozikPlaylist *SmoozikPlaylist::fromSnapshot(const QString &fileName, QObject *parent)
+{
+    SmoozikPlaylist *playlist = new SmoozikPlaylist(parent);
+    SmoozikPlaylistSnapshot snapshot;
+    if (!snapshot.load(fileName, playlist)) {
+        delete playlist;
+        return 0;
+    }
+    return playlist;
+}
+
+bool SmoozikPlaylist::saveSnapshot(const QString &fileName) const
+{
+    SmoozikPlaylistSnapshot snapshot;
+    return snapshot.save(this, fileName);
+}
+
 void SmoozikPlaylist::addTrack(SmoozikTrack *track)
 {
     if (!contains(track->localId())) {
+        _tracks.append(track->data());
         _list.append(track);
+        indexTrack(_tracks.size() - 1);
+    }
+}
+
+void SmoozikPlaylist::addTrack(const SmoozikTrackData &track)
+{
+    if (!contains(track.localId())) {
+        _tracks.append(track);
+        _list.append(0);
+        indexTrack(_tracks.size() - 1);
     }
 }
 
@@ -57,51 +105,153 @@ void SmoozikPlaylist::addTracks(const QDomDocument &doc)
 
 void SmoozikPlaylist::addTracks(const QVariantList &list)
 {
-
-    foreach(QVariant variant, list) {
-        if (!variant.toMap().isEmpty()) {
-            if (variant.toMap().contains("track")) {
-                addTrack(new SmoozikTrack(variant.toMap()["track"].toMap(), this));
-            }
+    QList<SmoozikTrackData> tracks;
+    tracks.reserve(list.size());
+    QVariantList::const_iterator end = list.constEnd();
+    for (QVariantList::const_iterator it = list.constBegin(); it != end; ++it) {
+        const QVariant &track = SmoozikXml::child(*it, "track");
+        if (track.isValid()) {
+            tracks.append(SmoozikTrackData::fromMap(track.toMap()));
         }
     }
+    addTracks(tracks);
 }
 
-bool SmoozikPlaylist::contains(const QString &localId) const
+QList<int> SmoozikPlaylist::addTracks(const QList<SmoozikTrackData> &tracks)
 {
+    QList<int> duplicates;
+    int size = _tracks.size() + tracks.size();
+    _tracks.reserve(size);
+    _list.reserve(size);
+    _localIdIndex.reserve(size);
 
-    foreach(SmoozikTrack *track, _list) {
-        if (track->localId() == localId) {
-            return true;
+    int trackCount = tracks.size();
+    for (int i = 0; i < trackCount; i++) {
+        const SmoozikTrackData &track = tracks.at(i);
+        if (_localIdIndex.contains(track.localId())) {
+            duplicates.append(i);
+            continue;
         }
+        // Copying a SmoozikTrackData only shares its data
+        _tracks.append(track);
+        _list.append(0);
+        indexTrack(_tracks.size() - 1);
     }
-    return false;
+    return duplicates;
+}
+
+bool SmoozikPlaylist::contains(const QString &localId) const
+{
+    return _localIdIndex.contains(localId);
 }
 
 int SmoozikPlaylist::indexOf(const QString &localId) const
 {
-    int listCount = count();
-    for (int i = 0; i < listCount; i++) {
-        if (value(i)->localId() == localId) {
-            return i;
-        }
-    }
-    return -1;
+    return _localIdIndex.value(localId, -1);
 }
 
 int SmoozikPlaylist::indexByFileName(const QString &fileName) const
 {
-    int listCount = count();
-    for (int i = 0; i < listCount; i++) {
-        if (value(i)->fileName() == fileName) {
-            return i;
+    return _fileNameIndex.value(fileName, -1);
+}
+
+void SmoozikPlaylist::removeAt(int i)
+{
+    const SmoozikTrackData &track = _tracks.at(i);
+    _localIdIndex.remove(track.localId());
+    if (_fileNameIndex.value(track.fileName(), -1) == i) {
+        _fileNameIndex.remove(track.fileName());
+    }
+
+    // Following tracks move one position back. The first of them sharing the removed fileName, if any, takes its place in the index.
+    int count = _tracks.size();
+    for (int j = i + 1; j < count; j++) {
+        const SmoozikTrackData &next = _tracks.at(j);
+        _localIdIndex[next.localId()] = j - 1;
+        QHash<QString, int>::iterator it = _fileNameIndex.find(next.fileName());
+        if (it == _fileNameIndex.end()) {
+            _fileNameIndex.insert(next.fileName(), j - 1);
+        } else if (it.value() == j) {
+            it.value() = j - 1;
         }
     }
-    return -1;
+
+    _tracks.removeAt(i);
+    _list.removeAt(i);
+}
+
+void SmoozikPlaylist::deleteTracks()
+{
+    qDeleteAll(_list);
+    clear();
 }
 
 SmoozikTrack *SmoozikPlaylist::random() const
 {
-    qsrand((uint)QTime::currentTime().msec());
-    return value(qrand() % size());
+    return value(randomIndex());
+}
+
+int SmoozikPlaylist::randomIndex() const
+{
+    return _tracks.isEmpty() ? -1 : _random.bounded(_tracks.size());
+}
+
+QList<int> SmoozikPlaylist::shuffledIndexes() const
+{
+    // Fisher-Yates shuffle
+    int listCount = _tracks.size();
+    QList<int> indexes;
+    indexes.reserve(listCount);
+    for (int i = 0; i < listCount; i++) {
+        indexes.append(i);
+    }
+    for (int i = listCount - 1; i > 0; i--) {
+        indexes.swap(i, _random.bounded(i + 1));
+    }
+    return indexes;
+}
+
+QList<int> SmoozikPlaylist::sampleIndexes(int count) const
+{
+    int listCount = _tracks.size();
+    if (count >= listCount) {
+        return shuffledIndexes();
+    }
+
+    // Partial Fisher-Yates shuffle of the virtual list 0 .. listCount - 1, only storing swapped positions
+    QList<int> indexes;
+    QHash<int, int> swapped;
+    indexes.reserve(count);
+    swapped.reserve(count);
+    for (int i = 0; i < count; i++) {
+        int j = i + _random.bounded(listCount - i);
+        int picked = swapped.value(j, j);
+        swapped.insert(j, swapped.value(i, i));
+        indexes.append(picked);
+    }
+    return indexes;
+}
+
+int SmoozikPlaylist::weightedIndex(const SmoozikAliasTable &weights) const
+{
+    int index = weights.sample(_random);
+    return (index < _tracks.size()) ? index : -1;
+}
+
+void SmoozikPlaylist::indexTrack(int i)
+{
+    const SmoozikTrackData &track = _tracks.at(i);
+    _localIdIndex.insert(track.localId(), i);
+    if (!_fileNameIndex.contains(track.fileName())) {
+        _fileNameIndex.insert(track.fileName(), i);
+    }
+}
+
+SmoozikTrack *SmoozikPlaylist::trackObject(int i) const
+{
+    SmoozikTrack *&track = _list[i];
+    if (!track) {
+        track = new SmoozikTrack(_tracks.at(i), const_cast<SmoozikPlaylist *>(this));
+    }
+    return track;
 }
@@ -23,10 +23,13 @@
 
 #include <QObject>
 #include <QVariantList>
+#include <QHash>
 #include <QDomDocument>
+#include <QNetworkReply>
 
 #include "global.h"
 #include "smooziktrack.h"
+#include "smoozikrandom.h"
 
 /**
  * @brief This is the max advised size of a playlist for user experience to stay enjoyable on mobile phones.
@@ -59,6 +62,34 @@ public:
 
     ~SmoozikPlaylist();
 
+    /**
+     * @brief Returns a new playlist filled with the tracks of getTopTracks response @em reply, or 0 if the response is an error.
+     *
+     * Tracks are decoded directly from the response, without building a QVariant tree.
+     * Both SmoozikManager::XML and SmoozikManager::JSON responses are accepted.
+     * The reply is deleted during the process. Use SmoozikXml::parseTracks() or SmoozikJson::parseTracks() to know the error.
+     * @param reply Response from Smoozik Server
+     * @param parent
+     */
+    static SmoozikPlaylist *fromReply(QNetworkReply *reply, QObject *parent = 0);
+
+    /**
+     * @brief Returns a new playlist filled with the tracks of the snapshot in file @em fileName, or 0 if it cannot be loaded.
+     *
+     * All tracks are decoded and copied when the snapshot is loaded; the playlist is not backed by the file.
+     * Use SmoozikTrackCatalog for lazy access to a snapshot mapped in memory.
+     * Use SmoozikPlaylistSnapshot to know the error.
+     * @param fileName File written by saveSnapshot()
+     * @param parent
+     */
+    static SmoozikPlaylist *fromSnapshot(const QString &fileName, QObject *parent = 0);
+
+    /**
+     * @brief Writes a binary snapshot of the playlist to file @em fileName. Returns true on success.
+     * @see SmoozikPlaylistSnapshot
+     */
+    bool saveSnapshot(const QString &fileName) const;
+
     /**
      * @brief Adds a track to the playlist.
      *
@@ -67,6 +98,15 @@ public:
      */
     void addTrack(SmoozikTrack *track);
 
+    /**
+     * @brief Adds a track to the playlist.
+     *
+     * If the playlist already has a track with this localId, the track is not added.
+     * No SmoozikTrack object is created until the track is accessed with value(), first(), last() or a take method.
+     * @param track
+     */
+    void addTrack(const SmoozikTrackData &track);
+
     /**
      * @brief Adds a track to the playlist.
      *
@@ -78,7 +118,7 @@ public:
      * @param duration Duration of the track
      */
     inline void addTrack(const QString &localId, const QString &name, const QString &artist = QString(), const QString &album = QString(), uint duration = 0, const QString &fileName = QString()) {
-        addTrack(new SmoozikTrack(localId, name, this, artist, album, duration, fileName));
+        addTrack(SmoozikTrackData(localId, name, artist, album, duration, fileName));
     }
 
     /**
@@ -93,8 +133,36 @@ public:
      */
     void addTracks(const QVariantList &list);
 
+    /**
+     * @brief Adds tracks @em tracks to the playlist in a single pass.
+     *
+     * Tracks whose localId is already in the playlist, or earlier in @em tracks, are not added.
+     * Capacity is reserved up front and duplicates are found with the localId index, so the cost is linear in the number of tracks.
+     * @param tracks Tracks to add
+     * @return Index positions in @em tracks of the tracks dropped as duplicates, in ascending order.
+     */
+    QList<int> addTracks(const QList<SmoozikTrackData> &tracks);
+
+    /**
+     * @brief Returns the track at index position @em i as a SmoozikTrackData, or a null track if @em i is out of range.
+     *
+     * Unlike value(), this does not create a SmoozikTrack object.
+     */
+    inline SmoozikTrackData trackData(int i) const {
+        return _tracks.value(i);
+    }
+
+    /**
+     * @brief Returns the tracks of the playlist as SmoozikTrackData.
+     */
+    inline QList<SmoozikTrackData> tracks() const {
+        return _tracks;
+    }
+
     /**
      * @brief Returns true if the playlist contains a track with @em localId; otherwise returns false.
+     *
+     * Lookups by localId and fileName use hash indexes and run in constant time.
      */
     bool contains(const QString &localId) const;
 
@@ -111,86 +179,156 @@ public:
     /**
      * @brief Clear playlist and deletes all playlist tracks.
      */
-    inline void deleteTracks() {
-        qDeleteAll(_list);
+    void deleteTracks();
+
+    /**
+     * @brief Seeds the random number generator of the playlist with @em seed.
+     *
+     * Each playlist has its own generator, seeded from the current time on construction.
+     * Seeding makes random(), randomIndex(), shuffledIndexes(), sampleIndexes() and weightedIndex() reproducible.
+     */
+    inline void setSeed(quint64 seed) {
+        _random.seed(seed);
     }
 
     /**
-     * @brief Returns a random track from the playlist.
+     * @brief Returns a random track from the playlist, or 0 if the playlist is empty.
      */
     SmoozikTrack *random() const;
 
+    /**
+     * @brief Returns the index position of a random track, or -1 if the playlist is empty.
+     */
+    int randomIndex() const;
+
+    /**
+     * @brief Returns all index positions of the playlist in random order.
+     *
+     * Iterating over it visits each track once, in a uniformly random order.
+     */
+    QList<int> shuffledIndexes() const;
+
+    /**
+     * @brief Returns @em count distinct index positions drawn at random, or all index positions in random order if @em count exceeds size().
+     *
+     * The cost is linear in @em count, not in the size of the playlist.
+     */
+    QList<int> sampleIndexes(int count) const;
+
+    /**
+     * @brief Returns the index position of a random track drawn according to @em weights, or -1 if @em weights is empty.
+     *
+     * @em weights should hold a weight for each track of the playlist, in the same order.
+     * Building the table is linear, but it can be reused for any number of draws as long as weights do not change.
+     */
+    int weightedIndex(const SmoozikAliasTable &weights) const;
+
     /**
      * @name QList methods
      */
     //@{
 
     inline void clear() {
-        return _list.clear();
+        _tracks.clear();
+        _list.clear();
+        _localIdIndex.clear();
+        _fileNameIndex.clear();
     } /**< Aggregation of QList equivalent method */
 
     inline int count() const {
-        return _list.count();
+        return _tracks.count();
     } /**< Aggregation of QList equivalent method */
 
     inline SmoozikTrack *first() {
-        return _list.first();
+        return trackObject(0);
     } /**< Aggregation of QList equivalent method */
 
     inline SmoozikTrack *first() const {
-        return _list.first();
+        return trackObject(0);
     } /**< Aggregation of QList equivalent method */
 
     inline bool isEmpty() const {
-        return _list.isEmpty();
+        return _tracks.isEmpty();
     } /**< Aggregation of QList equivalent method */
 
     inline SmoozikTrack *last() {
-        return _list.last();
+        return trackObject(_tracks.size() - 1);
     } /**< Aggregation of QList equivalent method */
 
     inline SmoozikTrack *last() const {
-        return _list.last();
+        return trackObject(_tracks.size() - 1);
     } /**< Aggregation of QList equivalent method */
 
-    inline void removeAt(int i) {
-        return _list.removeAt(i);
-    } /**< Aggregation of QList equivalent method */
+    void removeAt(int i); /**< Aggregation of QList equivalent method */
 
     inline void removeFirst() {
-        return _list.removeFirst();
+        removeAt(0);
     } /**< Aggregation of QList equivalent method */
 
     inline void removeLast() {
-        return _list.removeLast();
+        removeAt(_tracks.size() - 1);
     } /**< Aggregation of QList equivalent method */
 
     inline int size() const {
-        return _list.size();
+        return _tracks.size();
     } /**< Aggregation of QList equivalent method */
 
     inline SmoozikTrack *takeAt(int i) {
-        return _list.takeAt(i);
+        SmoozikTrack *track = trackObject(i);
+        removeAt(i);
+        return track;
     } /**< Aggregation of QList equivalent method */
 
     inline SmoozikTrack *takeFirst() {
-        return _list.takeFirst();
+        return takeAt(0);
     } /**< Aggregation of QList equivalent method */
 
     inline SmoozikTrack *takeLast() {
-        return _list.takeLast();
+        return takeAt(_tracks.size() - 1);
     } /**< Aggregation of QList equivalent method */
 
     inline SmoozikTrack *value(int i) const {
-        return _list.value(i);
+        return (i >= 0 && i < _tracks.size()) ? trackObject(i) : 0;
     } /**< Aggregation of QList equivalent method */
     //@}
 
 private:
     /**
-     * @brief This property holds the QList containing the SmoozikTrack objects.
+     * @brief Returns the SmoozikTrack object of track at index position @em i, creating it if needed.
+     */
+    SmoozikTrack *trackObject(int i) const;
+
+    /**
+     * @brief Adds track at index position @em i to the hash indexes.
+     */
+    void indexTrack(int i);
+
+    /**
+     * @brief This property holds the tracks of the playlist.
+     */
+    QList<SmoozikTrackData> _tracks;
+
+    /**
+     * @brief This property holds the SmoozikTrack objects of the playlist, at the same index positions as in #_tracks.
+     *
+     * Objects are created on first access; until then, entries are 0.
+     */
+    mutable QList<SmoozikTrack *> _list;
+
+    /**
+     * @brief This property holds the index position of each localId in #_tracks.
+     */
+    QHash<QString, int> _localIdIndex;
+
+    /**
+     * @brief This property holds the index position of the first track with each fileName in #_tracks.
+     */
+    QHash<QString, int> _fileNameIndex;
+
+    /**
+     * @brief This property holds the random number generator of the playlist.
      */
-    QList<SmoozikTrack *> _list;
+    mutable SmoozikRandom _random;
 };
 
 #endif // SMOOZIKPLAYLIST_H
@@ -0,0 +1,69 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smoozikplaylistdelta.h"
+#include "smoozikplaylist.h"
+
+/**
+ * @brief Returns true if @em a and @em b have the same properties as seen by the server.
+ *
+ * fileName only locates the track on the local computer and is never sent, so it is not compared.
+ */
+static bool sameServerProperties(const SmoozikTrackData &a, const SmoozikTrackData &b)
+{
+    return a.localId() == b.localId() && a.name() == b.name() && a.artist() == b.artist() && a.album() == b.album() && a.duration() == b.duration();
+}
+
+SmoozikPlaylistDelta::SmoozikPlaylistDelta()
+{
+}
+
+SmoozikPlaylistDelta::SmoozikPlaylistDelta(const SmoozikPlaylist *from, const SmoozikPlaylist *to)
+{
+    compute(from, to);
+}
+
+void SmoozikPlaylistDelta::compute(const SmoozikPlaylist *from, const SmoozikPlaylist *to)
+{
+    _added.clear();
+    _changed.clear();
+    _removed.clear();
+
+    int toCount = to->size();
+    for (int i = 0; i < toCount; i++) {
+        SmoozikTrackData track = to->trackData(i);
+        int index = from ? from->indexOf(track.localId()) : -1;
+        if (index < 0) {
+            _added.append(track);
+        } else if (!sameServerProperties(from->trackData(index), track)) {
+            _changed.append(track);
+        }
+    }
+
+    if (from) {
+        int fromCount = from->size();
+        for (int i = 0; i < fromCount; i++) {
+            SmoozikTrackData track = from->trackData(i);
+            if (!to->contains(track.localId())) {
+                _removed.append(track.localId());
+            }
+        }
+    }
+}
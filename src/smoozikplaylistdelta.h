@@ -0,0 +1,103 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKPLAYLISTDELTA_H
+#define SMOOZIKPLAYLISTDELTA_H
+
+#include <QList>
+#include <QStringList>
+
+#include "global.h"
+#include "smooziktrackdata.h"
+
+class SmoozikPlaylist;
+
+/**
+ * @brief The SmoozikPlaylistDelta class holds the differences between two snapshots of a playlist.
+ *
+ * Tracks are matched by localId: a track is added if its localId is only in the new playlist, removed if it is only in the old one,
+ * and changed if it is in both with different properties. The order of tracks is not taken into account,
+ * nor is fileName, which is never sent to the server.
+ * Computing a delta is linear in the size of both playlists, thanks to SmoozikPlaylist localId index.
+ *
+ * SmoozikManager::updatePlaylist() uses it to upload only what changed.
+ */
+class SMOOZIKLIB_EXPORT SmoozikPlaylistDelta
+{
+public:
+    /**
+     * @brief Constructs an empty delta.
+     */
+    SmoozikPlaylistDelta();
+    /**
+     * @brief Constructs the delta from playlist @em from to playlist @em to.
+     * @see compute()
+     */
+    SmoozikPlaylistDelta(const SmoozikPlaylist *from, const SmoozikPlaylist *to);
+
+    /**
+     * @brief Computes the delta from playlist @em from to playlist @em to, replacing the current delta.
+     *
+     * A null @em from is an empty playlist.
+     */
+    void compute(const SmoozikPlaylist *from, const SmoozikPlaylist *to);
+
+    /**
+     * @brief Returns the tracks of the new playlist which are not in the old one, in the order of the new playlist.
+     */
+    inline QList<SmoozikTrackData> added() const {
+        return _added;
+    }
+
+    /**
+     * @brief Returns the tracks which are in both playlists with different properties, with their new properties, in the order of the new playlist.
+     */
+    inline QList<SmoozikTrackData> changed() const {
+        return _changed;
+    }
+
+    /**
+     * @brief Returns the localIds of the tracks of the old playlist which are not in the new one, in the order of the old playlist.
+     */
+    inline QStringList removed() const {
+        return _removed;
+    }
+
+    /**
+     * @brief Returns the number of added, changed and removed tracks.
+     */
+    inline int count() const {
+        return _added.size() + _changed.size() + _removed.size();
+    }
+
+    /**
+     * @brief Returns true if both playlists hold the same tracks.
+     */
+    inline bool isEmpty() const {
+        return count() == 0;
+    }
+
+private:
+    QList<SmoozikTrackData> _added; /**< @see added() */
+    QList<SmoozikTrackData> _changed; /**< @see changed() */
+    QStringList _removed; /**< @see removed() */
+};
+
+#endif // SMOOZIKPLAYLISTDELTA_H
@@ -0,0 +1,312 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smoozikplaylistsnapshot.h"
+#include "smoozikplaylist.h"
+
+#include <QFile>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#include <QSaveFile>
+#endif
+#include <QCoreApplication>
+#include <QHash>
+#include <QVector>
+#include <QtEndian>
+
+/**
+ * @brief Size in bytes of the snapshot header.
+ */
+static const int headerSize = 28;
+
+/**
+ * @brief Size in bytes of a track record.
+ */
+static const int recordSize = 24;
+
+/**
+ * @brief Appends @em value to @em data as a 32-bit little-endian integer.
+ */
+static inline void appendUInt32(QByteArray &data, quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    data.append((const char *)bytes, 4);
+}
+
+/**
+ * @brief Returns the 32-bit little-endian integer at @em data.
+ */
+static inline quint32 readUInt32(const char *data)
+{
+    return qFromLittleEndian<quint32>((const uchar *)data);
+}
+
+SmoozikPlaylistSnapshot::SmoozikPlaylistSnapshot() :
+    _cacheStrings(true)
+{
+    close();
+}
+
+quint32 SmoozikPlaylistSnapshot::crc32(const char *data, int size)
+{
+    // Half-byte table of the reflected 0xEDB88320 polynomial
+    static const quint32 table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    quint32 crc = 0xFFFFFFFF;
+    for (int i = 0; i < size; i++) {
+        crc ^= (uchar)data[i];
+        crc = (crc >> 4) ^ table[crc & 0xF];
+        crc = (crc >> 4) ^ table[crc & 0xF];
+    }
+    return ~crc;
+}
+
+bool SmoozikPlaylistSnapshot::save(const SmoozikPlaylist *playlist, QIODevice *device)
+{
+    _errorString = QString();
+    int trackCount = playlist->size();
+
+    // String 0 is the empty string
+    QHash<QString, quint32> ids;
+    QByteArray offsets;
+    QByteArray strings;
+    appendUInt32(offsets, 0);
+    appendUInt32(offsets, 0);
+    quint32 stringCount = 1;
+
+    QByteArray body;
+    body.reserve(trackCount * recordSize);
+    for (int i = 0; i < trackCount; i++) {
+        SmoozikTrackData track = playlist->trackData(i);
+        QString values[5] = {track.localId(), track.name(), track.artist(), track.album(), track.fileName()};
+        for (int j = 0; j < 5; j++) {
+            quint32 id = 0;
+            if (!values[j].isEmpty()) {
+                QHash<QString, quint32>::const_iterator it = ids.constFind(values[j]);
+                if (it != ids.constEnd()) {
+                    id = it.value();
+                } else {
+                    id = stringCount++;
+                    ids.insert(values[j], id);
+                    strings.append(values[j].toUtf8());
+                    appendUInt32(offsets, strings.size());
+                }
+            }
+            appendUInt32(body, id);
+        }
+        appendUInt32(body, track.duration());
+    }
+    body.append(offsets);
+    body.append(strings);
+
+    QByteArray header("SMZP");
+    appendUInt32(header, Version);
+    appendUInt32(header, trackCount);
+    appendUInt32(header, stringCount);
+    appendUInt32(header, strings.size());
+    appendUInt32(header, crc32(body.constData(), body.size()));
+    appendUInt32(header, 0); // Reserved
+
+    if (device->write(header) != header.size() || device->write(body) != body.size()) {
+        _errorString = device->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool SmoozikPlaylistSnapshot::save(const SmoozikPlaylist *playlist, const QString &fileName)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    // The previous snapshot is only replaced once the new one is completely written
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        _errorString = file.errorString();
+        return false;
+    }
+    if (!save(playlist, &file)) {
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        _errorString = file.errorString();
+        return false;
+    }
+    return true;
+#else
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        _errorString = file.errorString();
+        return false;
+    }
+    return save(playlist, &file);
+#endif
+}
+
+bool SmoozikPlaylistSnapshot::open(const QByteArray &data)
+{
+    close();
+    _errorString = QString();
+    const char *bytes = data.constData();
+    if (data.size() < headerSize || !data.startsWith("SMZP")) {
+        _errorString = QCoreApplication::translate("SmoozikPlaylistSnapshot", "Not a playlist snapshot");
+        return false;
+    }
+    quint32 version = readUInt32(bytes + 4);
+    if (version != Version) {
+        _errorString = QCoreApplication::translate("SmoozikPlaylistSnapshot", "Unsupported snapshot version %1").arg(version);
+        return false;
+    }
+
+    // Sizes are checked in 64 bits so that corrupted counts cannot overflow
+    quint64 trackCount = readUInt32(bytes + 8);
+    quint64 stringCount = readUInt32(bytes + 12);
+    quint64 stringDataSize = readUInt32(bytes + 16);
+    quint64 expectedSize = headerSize + trackCount * recordSize + (stringCount + 1) * 4 + stringDataSize;
+    if (stringCount < 1 || expectedSize != (quint64)data.size()) {
+        _errorString = QCoreApplication::translate("SmoozikPlaylistSnapshot", "Truncated or corrupted snapshot");
+        return false;
+    }
+    if (crc32(bytes + headerSize, data.size() - headerSize) != readUInt32(bytes + 20)) {
+        _errorString = QCoreApplication::translate("SmoozikPlaylistSnapshot", "Snapshot checksum mismatch");
+        return false;
+    }
+
+    const char *records = bytes + headerSize;
+    const char *offsets = records + trackCount * recordSize;
+
+    // Offsets must be ordered within string data, and ids within the string table
+    quint32 previous = 0;
+    for (quint64 i = 0; i <= stringCount; i++) {
+        quint32 offset = readUInt32(offsets + 4 * i);
+        if (offset < previous || offset > stringDataSize) {
+            _errorString = QCoreApplication::translate("SmoozikPlaylistSnapshot", "Corrupted snapshot string table");
+            return false;
+        }
+        previous = offset;
+    }
+    for (quint64 i = 0; i < trackCount; i++) {
+        for (int j = 0; j < 5; j++) {
+            if (readUInt32(records + i * recordSize + 4 * j) >= stringCount) {
+                _errorString = QCoreApplication::translate("SmoozikPlaylistSnapshot", "Corrupted snapshot track record");
+                return false;
+            }
+        }
+    }
+
+    _data = data;
+    _records = records;
+    _offsets = offsets;
+    _strings = offsets + (stringCount + 1) * 4;
+    _trackCount = (int)trackCount;
+    if (_cacheStrings) {
+        _decodedStrings.resize((int)stringCount);
+        _decoded.fill(false, (int)stringCount);
+    }
+    return true;
+}
+
+void SmoozikPlaylistSnapshot::close()
+{
+    _data = QByteArray();
+    _records = 0;
+    _offsets = 0;
+    _strings = 0;
+    _trackCount = 0;
+    _decodedStrings.clear();
+    _decoded.clear();
+}
+
+QString SmoozikPlaylistSnapshot::recordString(int i, int field) const
+{
+    return string(readUInt32(_records + i * recordSize + 4 * field));
+}
+
+QByteArray SmoozikPlaylistSnapshot::recordBytes(int i, int field) const
+{
+    return stringBytes(readUInt32(_records + i * recordSize + 4 * field));
+}
+
+QString SmoozikPlaylistSnapshot::string(quint32 id) const
+{
+    if (!_cacheStrings) {
+        return decodeString(id);
+    }
+    if (!_decoded.at(id)) {
+        _decodedStrings[id] = decodeString(id);
+        _decoded[id] = true;
+    }
+    return _decodedStrings.at(id);
+}
+
+QString SmoozikPlaylistSnapshot::decodeString(quint32 id) const
+{
+    quint32 begin = readUInt32(_offsets + 4 * id);
+    quint32 end = readUInt32(_offsets + 4 * (id + 1));
+    return (end > begin) ? QString::fromUtf8(_strings + begin, end - begin) : QString();
+}
+
+QByteArray SmoozikPlaylistSnapshot::stringBytes(quint32 id) const
+{
+    quint32 begin = readUInt32(_offsets + 4 * id);
+    quint32 end = readUInt32(_offsets + 4 * (id + 1));
+    return QByteArray::fromRawData(_strings + begin, end - begin);
+}
+
+SmoozikTrackData SmoozikPlaylistSnapshot::trackData(int i) const
+{
+    return SmoozikTrackData(recordString(i, 0), recordString(i, 1), recordString(i, 2), recordString(i, 3),
+                            readUInt32(_records + i * recordSize + 20), recordString(i, 4));
+}
+
+bool SmoozikPlaylistSnapshot::load(const QByteArray &data, SmoozikPlaylist *playlist)
+{
+    if (!open(data)) {
+        return false;
+    }
+    QList<SmoozikTrackData> tracks;
+    tracks.reserve(_trackCount);
+    for (int i = 0; i < _trackCount; i++) {
+        tracks.append(trackData(i));
+    }
+    close();
+    playlist->addTracks(tracks);
+    return true;
+}
+
+bool SmoozikPlaylistSnapshot::load(const QString &fileName, SmoozikPlaylist *playlist)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        _errorString = file.errorString();
+        return false;
+    }
+
+    // Decoded strings are copies, so the mapping is only needed while loading
+    qint64 size = file.size();
+    uchar *map = (size > 0) ? file.map(0, size) : 0;
+    if (map) {
+        bool loaded = load(QByteArray::fromRawData((const char *)map, size), playlist);
+        file.unmap(map);
+        return loaded;
+    }
+    return load(file.readAll(), playlist);
+}
@@ -0,0 +1,215 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKPLAYLISTSNAPSHOT_H
+#define SMOOZIKPLAYLISTSNAPSHOT_H
+
+#include <QString>
+#include <QByteArray>
+#include <QIODevice>
+#include <QVector>
+
+#include "global.h"
+#include "smooziktrackdata.h"
+
+class SmoozikPlaylist;
+
+/**
+ * @brief The SmoozikPlaylistSnapshot class saves playlists to and loads them from a compact binary format.
+ *
+ * A snapshot is made of, in this order, all integers being 32-bit little-endian:
+ * - a header: "SMZP" magic, format version, track count, string count, size of string data, CRC-32 of everything after the header and a reserved 0;
+ * - fixed-width track records: string ids of localId, name, artist, album and fileName, then duration;
+ * - the string table: string count + 1 offsets into string data, then UTF-8 string data.
+ *
+ * Strings are stored once, so artists and albums shared by many tracks are decoded once and shared by their tracks.
+ * Files are loaded through QFile::map() and a string is only decoded the first time a record refers to it.
+ * Loading is eager: every track is decoded and copied into the playlist, and the file is unmapped before load() returns.
+ * Use SmoozikTrackCatalog to look tracks up in a snapshot kept mapped in memory.
+ *
+ * A snapshot can also be opened with open() and its records read one by one, without loading them in a playlist, as SmoozikTrackCatalog does.
+ * Reading records is not thread-safe, since it fills the cache of decoded strings, unless this cache is disabled with setCacheStrings().
+ */
+class SMOOZIKLIB_EXPORT SmoozikPlaylistSnapshot
+{
+public:
+    enum {
+        Version = 1 /**< Version of the format written by save() */
+    };
+
+    SmoozikPlaylistSnapshot();
+
+    /**
+     * @brief Writes a snapshot of @em playlist to @em device, which must be open for writing.
+     * @retval true if the snapshot was written.
+     * @retval false otherwise. The error is accessible with errorString().
+     */
+    bool save(const SmoozikPlaylist *playlist, QIODevice *device);
+
+    /**
+     * @brief Writes a snapshot of @em playlist to file @em fileName, replacing it.
+     * @see save(const SmoozikPlaylist *, QIODevice *)
+     */
+    bool save(const SmoozikPlaylist *playlist, const QString &fileName);
+
+    /**
+     * @brief Adds the tracks of snapshot @em data to @em playlist.
+     *
+     * The snapshot is checked entirely before any track is added: if it is corrupted or has an unknown version, @em playlist is left unchanged.
+     * @retval true if the snapshot was loaded.
+     * @retval false otherwise. The error is accessible with errorString().
+     */
+    bool load(const QByteArray &data, SmoozikPlaylist *playlist);
+
+    /**
+     * @brief Adds the tracks of the snapshot in file @em fileName to @em playlist.
+     *
+     * The file is mapped in memory rather than read, when the platform allows it, and unmapped before returning:
+     * @em playlist holds copies of the tracks and does not depend on the file afterwards.
+     * @see load(const QByteArray &, SmoozikPlaylist *)
+     */
+    bool load(const QString &fileName, SmoozikPlaylist *playlist);
+
+    /**
+     * @brief Opens snapshot @em data to read its records, closing the snapshot previously opened.
+     *
+     * The whole snapshot is checked. @em data must stay valid until the snapshot is closed, which matters for data created with QByteArray::fromRawData().
+     * @retval true if the snapshot is valid.
+     * @retval false otherwise. The error is accessible with errorString().
+     */
+    bool open(const QByteArray &data);
+
+    /**
+     * @brief Returns whether decoded strings are cached, so that a string shared by several records is decoded once. Default is true.
+     */
+    inline bool cacheStrings() const {
+        return _cacheStrings;
+    }
+
+    /**
+     * @brief Sets whether decoded strings are cached. It takes effect on next call to open().
+     *
+     * Without cache, strings are decoded from the snapshot data each time a record is read, and reading records never modifies the snapshot,
+     * so that they can be read from several threads.
+     */
+    inline void setCacheStrings(bool cacheStrings) {
+        _cacheStrings = cacheStrings;
+    }
+
+    /**
+     * @brief Closes the snapshot opened with open().
+     */
+    void close();
+
+    /**
+     * @brief Returns the number of tracks of the opened snapshot.
+     */
+    inline int count() const {
+        return _trackCount;
+    }
+
+    /**
+     * @brief Returns track @em i of the opened snapshot.
+     */
+    SmoozikTrackData trackData(int i) const;
+
+    /**
+     * @brief Returns the localId of track @em i of the opened snapshot.
+     */
+    inline QString localId(int i) const {
+        return recordString(i, 0);
+    }
+
+    /**
+     * @brief Returns the fileName of track @em i of the opened snapshot.
+     */
+    inline QString fileName(int i) const {
+        return recordString(i, 4);
+    }
+
+    /**
+     * @brief Returns the UTF-8 localId of track @em i of the opened snapshot, referring to the snapshot data without copying it.
+     */
+    inline QByteArray localIdBytes(int i) const {
+        return recordBytes(i, 0);
+    }
+
+    /**
+     * @brief Returns the UTF-8 fileName of track @em i of the opened snapshot, referring to the snapshot data without copying it.
+     */
+    inline QByteArray fileNameBytes(int i) const {
+        return recordBytes(i, 4);
+    }
+
+    /**
+     * @brief Returns the error of the last call to save(), load() or open(), or a null string if it succeeded.
+     */
+    inline QString errorString() const {
+        return _errorString;
+    }
+
+    /**
+     * @brief Returns the CRC-32 of @em size bytes at @em data, as computed by zlib.
+     */
+    static quint32 crc32(const char *data, int size);
+
+private:
+    /**
+     * @brief Returns string @em field of track @em i of the opened snapshot, @em field being the position of the string id in the record.
+     */
+    QString recordString(int i, int field) const;
+
+    /**
+     * @brief Returns the UTF-8 bytes of string @em field of track @em i of the opened snapshot, without copy.
+     * @see recordString()
+     */
+    QByteArray recordBytes(int i, int field) const;
+
+    /**
+     * @brief Returns string @em id of the opened snapshot, decoding it on first access if #_cacheStrings.
+     */
+    QString string(quint32 id) const;
+
+    /**
+     * @brief Decodes string @em id of the opened snapshot.
+     */
+    QString decodeString(quint32 id) const;
+
+    /**
+     * @brief Returns the UTF-8 bytes of string @em id of the opened snapshot, referring to the snapshot data without copying it.
+     */
+    QByteArray stringBytes(quint32 id) const;
+
+    /**
+     * @brief This property holds the error of the last call to save(), load() or open().
+     */
+    QString _errorString;
+
+    QByteArray _data; /**< Opened snapshot */
+    const char *_records; /**< Track records of #_data */
+    const char *_offsets; /**< String offsets of #_data */
+    const char *_strings; /**< String data of #_data */
+    int _trackCount; /**< @see count() */
+    bool _cacheStrings; /**< @see cacheStrings() */
+    mutable QVector<QString> _decodedStrings; /**< Strings decoded so far, by id */
+    mutable QVector<bool> _decoded; /**< Whether each string has been decoded */
+};
+
+#endif // SMOOZIKPLAYLISTSNAPSHOT_H
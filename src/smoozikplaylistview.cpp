@@ -0,0 +1,98 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smoozikplaylistview.h"
+#include "smoozikplaylist.h"
+
+SmoozikPlaylistView::SmoozikPlaylistView(const SmoozikTrackCatalog *catalog) :
+    _catalog(catalog)
+{
+}
+
+bool SmoozikPlaylistView::addTrack(quint32 catalogIndex)
+{
+    if (catalogIndex >= (quint32)_catalog->count() || _positions.contains(catalogIndex)) {
+        return false;
+    }
+    QByteArray fileName = _catalog->fileNameBytes(catalogIndex);
+    if (!_fileNamePositions.contains(fileName)) {
+        _fileNamePositions.insert(fileName, _indexes.size());
+    }
+    _positions.insert(catalogIndex, _indexes.size());
+    _indexes.append(catalogIndex);
+    return true;
+}
+
+bool SmoozikPlaylistView::addTrack(const QString &localId)
+{
+    int catalogIndex = _catalog->indexOf(localId);
+    return (catalogIndex >= 0) && addTrack((quint32)catalogIndex);
+}
+
+QList<SmoozikTrackData> SmoozikPlaylistView::tracks() const
+{
+    QList<SmoozikTrackData> tracks;
+    tracks.reserve(_indexes.size());
+    foreach(quint32 catalogIndex, _indexes) {
+        tracks.append(_catalog->trackData(catalogIndex));
+    }
+    return tracks;
+}
+
+int SmoozikPlaylistView::indexOf(const QString &localId) const
+{
+    int catalogIndex = _catalog->indexOf(localId);
+    return (catalogIndex >= 0) ? _positions.value((quint32)catalogIndex, -1) : -1;
+}
+
+int SmoozikPlaylistView::indexByFileName(const QString &fileName) const
+{
+    return _fileNamePositions.value(fileName.toUtf8(), -1);
+}
+
+void SmoozikPlaylistView::removeAt(int i)
+{
+    _positions.remove(_indexes.at(i));
+    QByteArray fileName = _catalog->fileNameBytes(_indexes.at(i));
+    if (_fileNamePositions.value(fileName, -1) == i) {
+        _fileNamePositions.remove(fileName);
+    }
+
+    // Following tracks move one position back. The first of them sharing the removed fileName, if any, takes its place in the index.
+    int listCount = _indexes.size();
+    for (int j = i + 1; j < listCount; j++) {
+        quint32 catalogIndex = _indexes.at(j);
+        _positions[catalogIndex] = j - 1;
+        QHash<QByteArray, int>::iterator it = _fileNamePositions.find(_catalog->fileNameBytes(catalogIndex));
+        if (it == _fileNamePositions.end()) {
+            _fileNamePositions.insert(_catalog->fileNameBytes(catalogIndex), j - 1);
+        } else if (it.value() == j) {
+            it.value() = j - 1;
+        }
+    }
+    _indexes.remove(i);
+}
+
+SmoozikPlaylist *SmoozikPlaylistView::toPlaylist(QObject *parent) const
+{
+    SmoozikPlaylist *playlist = new SmoozikPlaylist(parent);
+    playlist->addTracks(tracks());
+    return playlist;
+}
@@ -0,0 +1,175 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKPLAYLISTVIEW_H
+#define SMOOZIKPLAYLISTVIEW_H
+
+#include <QVector>
+#include <QList>
+#include <QHash>
+
+#include "global.h"
+#include "smooziktrackcatalog.h"
+
+class SmoozikPlaylist;
+
+/**
+ * @brief The SmoozikPlaylistView class is a playlist made of tracks of a SmoozikTrackCatalog.
+ *
+ * It only stores the 32-bit catalog index of each track, so that the playlists of several parties can share one catalog
+ * instead of each holding copies of track metadata. Track properties are read from the catalog when accessed.
+ *
+ * It offers the query API of SmoozikPlaylist, except for methods returning SmoozikTrack objects, and can be sent with SmoozikManager::sendPlaylist().
+ * toPlaylist() converts it to a SmoozikPlaylist when needed.
+ */
+class SMOOZIKLIB_EXPORT SmoozikPlaylistView
+{
+public:
+    /**
+     * @brief Constructs an empty view on @em catalog, which must outlive the view.
+     */
+    explicit SmoozikPlaylistView(const SmoozikTrackCatalog *catalog);
+
+    /**
+     * @brief Returns the catalog of the view.
+     */
+    inline const SmoozikTrackCatalog *catalog() const {
+        return _catalog;
+    }
+
+    /**
+     * @brief Adds track @em catalogIndex of the catalog to the view.
+     *
+     * If the view already has this track, or if @em catalogIndex is out of range, the track is not added.
+     * @return true if the track was added.
+     */
+    bool addTrack(quint32 catalogIndex);
+
+    /**
+     * @brief Adds the track of the catalog with @em localId to the view.
+     * @see addTrack(quint32)
+     */
+    bool addTrack(const QString &localId);
+
+    /**
+     * @brief Returns the catalog index of the track at index position @em i.
+     */
+    inline quint32 catalogIndex(int i) const {
+        return _indexes.at(i);
+    }
+
+    /**
+     * @brief Returns the catalog indexes of the tracks of the view.
+     */
+    inline QVector<quint32> catalogIndexes() const {
+        return _indexes;
+    }
+
+    /**
+     * @brief Returns the track at index position @em i, or a null track if @em i is out of range.
+     */
+    inline SmoozikTrackData trackData(int i) const {
+        return (i >= 0 && i < _indexes.size()) ? _catalog->trackData(_indexes.at(i)) : SmoozikTrackData();
+    }
+
+    /**
+     * @brief Returns the tracks of the view.
+     */
+    QList<SmoozikTrackData> tracks() const;
+
+    /**
+     * @brief Returns true if the view contains a track with @em localId; otherwise returns false.
+     */
+    inline bool contains(const QString &localId) const {
+        return indexOf(localId) != -1;
+    }
+
+    /**
+     * @brief Returns the index position of the track with @em localId in the view. Returns -1 if no item matched.
+     */
+    int indexOf(const QString &localId) const;
+
+    /**
+     * @brief Returns the index position of the first occurrence of track with @em fileName in the view. Returns -1 if no item matched.
+     */
+    int indexByFileName(const QString &fileName) const;
+
+    /**
+     * @brief Returns a new playlist filled with the tracks of the view.
+     */
+    SmoozikPlaylist *toPlaylist(QObject *parent = 0) const;
+
+    /**
+     * @name QList methods
+     */
+    //@{
+
+    inline void clear() {
+        _indexes.clear();
+        _positions.clear();
+        _fileNamePositions.clear();
+    } /**< Aggregation of QList equivalent method */
+
+    inline int count() const {
+        return _indexes.count();
+    } /**< Aggregation of QList equivalent method */
+
+    inline bool isEmpty() const {
+        return _indexes.isEmpty();
+    } /**< Aggregation of QList equivalent method */
+
+    void removeAt(int i); /**< Aggregation of QList equivalent method */
+
+    inline void removeFirst() {
+        removeAt(0);
+    } /**< Aggregation of QList equivalent method */
+
+    inline void removeLast() {
+        removeAt(_indexes.size() - 1);
+    } /**< Aggregation of QList equivalent method */
+
+    inline int size() const {
+        return _indexes.size();
+    } /**< Aggregation of QList equivalent method */
+    //@}
+
+private:
+    /**
+     * @brief This property holds the catalog of the view.
+     */
+    const SmoozikTrackCatalog *_catalog;
+
+    /**
+     * @brief This property holds the catalog index of each track of the view.
+     */
+    QVector<quint32> _indexes;
+
+    /**
+     * @brief This property holds the index position in #_indexes of each catalog index, so that adding and finding tracks does not scan the view.
+     */
+    QHash<quint32, int> _positions;
+
+    /**
+     * @brief This property holds the index position of the first track with each UTF-8 fileName, referring to the catalog data.
+     */
+    QHash<QByteArray, int> _fileNamePositions;
+};
+
+#endif // SMOOZIKPLAYLISTVIEW_H
@@ -0,0 +1,135 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smoozikrandom.h"
+
+#include <QDateTime>
+
+SmoozikRandom::SmoozikRandom()
+{
+    seed((quint64)QDateTime::currentMSecsSinceEpoch() ^ (quint64)(quintptr)this);
+}
+
+SmoozikRandom::SmoozikRandom(quint64 seed)
+{
+    this->seed(seed);
+}
+
+void SmoozikRandom::seed(quint64 seed)
+{
+    // Initialization sequence of the reference implementation
+    _state = 0;
+    next();
+    _state += seed;
+    next();
+}
+
+int SmoozikRandom::bounded(int bound)
+{
+    if (bound <= 0) {
+        return 0;
+    }
+    // Rejecting the lowest values removes the bias of the modulo
+    quint32 range = (quint32)bound;
+    quint32 threshold = (0u - range) % range;
+    quint32 value;
+    do {
+        value = next();
+    } while (value < threshold);
+    return (int)(value % range);
+}
+
+SmoozikAliasTable::SmoozikAliasTable()
+{
+}
+
+SmoozikAliasTable::SmoozikAliasTable(const QVector<double> &weights)
+{
+    setWeights(weights);
+}
+
+void SmoozikAliasTable::setWeights(const QVector<double> &weights)
+{
+    _probability.resize(0);
+    _alias.resize(0);
+
+    int n = weights.size();
+    double total = 0;
+    for (int i = 0; i < n; i++) {
+        if (weights.at(i) > 0) {
+            total += weights.at(i);
+        }
+    }
+    if (total <= 0) {
+        return;
+    }
+
+    // Scale weights so that their mean is 1, then pair each index below 1 with one above
+    _probability.resize(n);
+    _alias.resize(n);
+    QVector<double> scaled(n);
+    QVector<int> small;
+    QVector<int> large;
+    small.reserve(n);
+    large.reserve(n);
+    for (int i = 0; i < n; i++) {
+        scaled[i] = (weights.at(i) > 0) ? weights.at(i) * n / total : 0;
+        if (scaled.at(i) < 1) {
+            small.append(i);
+        } else {
+            large.append(i);
+        }
+    }
+
+    while (!small.isEmpty() && !large.isEmpty()) {
+        int less = small.last();
+        small.resize(small.size() - 1);
+        int more = large.last();
+        large.resize(large.size() - 1);
+
+        _probability[less] = scaled.at(less);
+        _alias[less] = more;
+        scaled[more] = scaled.at(more) + scaled.at(less) - 1;
+        if (scaled.at(more) < 1) {
+            small.append(more);
+        } else {
+            large.append(more);
+        }
+    }
+
+    // Remaining indexes are 1 up to rounding errors
+    foreach(int i, large) {
+        _probability[i] = 1;
+        _alias[i] = i;
+    }
+    foreach(int i, small) {
+        _probability[i] = 1;
+        _alias[i] = i;
+    }
+}
+
+int SmoozikAliasTable::sample(SmoozikRandom &random) const
+{
+    if (_alias.isEmpty()) {
+        return -1;
+    }
+    int i = random.bounded(_alias.size());
+    return (random.real() < _probability.at(i)) ? i : _alias.at(i);
+}
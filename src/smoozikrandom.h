@@ -0,0 +1,136 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKRANDOM_H
+#define SMOOZIKRANDOM_H
+
+#include <QVector>
+
+#include "global.h"
+
+/**
+ * @brief The SmoozikRandom class is a small and fast pseudo-random number generator.
+ *
+ * It implements PCG32: 64 bits of state, 32-bit outputs of good statistical quality, and a few instructions per number.
+ * Unlike qrand(), each generator has its own state, so generators do not interfere with each other and a seed reproduces a sequence.
+ * It is not suitable for cryptography.
+ */
+class SMOOZIKLIB_EXPORT SmoozikRandom
+{
+public:
+    /**
+     * @brief Constructs a generator seeded from the current time and the generator address.
+     */
+    SmoozikRandom();
+    /**
+     * @brief Constructs a generator seeded with @em seed.
+     */
+    explicit SmoozikRandom(quint64 seed);
+
+    /**
+     * @brief Restarts the generator from @em seed. Generators with the same seed produce the same sequence.
+     */
+    void seed(quint64 seed);
+
+    /**
+     * @brief Returns the next 32-bit random number.
+     */
+    inline quint32 next() {
+        quint64 state = _state;
+        _state = state * Q_UINT64_C(6364136223846793005) + Q_UINT64_C(1442695040888963407);
+        quint32 xorShifted = (quint32)(((state >> 18) ^ state) >> 27);
+        quint32 rotation = (quint32)(state >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31));
+    }
+
+    /**
+     * @brief Returns a random number uniformly distributed in [0, @em bound[, or 0 if @em bound is not positive.
+     */
+    int bounded(int bound);
+
+    /**
+     * @brief Returns a random number uniformly distributed in [0, 1[.
+     */
+    inline double real() {
+        return next() * (1.0 / 4294967296.0);
+    }
+
+private:
+    /**
+     * @brief This property holds the state of the generator.
+     */
+    quint64 _state;
+};
+
+/**
+ * @brief The SmoozikAliasTable class samples indexes according to weights in constant time.
+ *
+ * It implements Vose's alias method: building the table is linear in the number of weights, then each sample() costs one bounded random number and one real random number.
+ */
+class SMOOZIKLIB_EXPORT SmoozikAliasTable
+{
+public:
+    SmoozikAliasTable();
+    /**
+     * @brief Constructs a table for @em weights.
+     * @see setWeights()
+     */
+    explicit SmoozikAliasTable(const QVector<double> &weights);
+
+    /**
+     * @brief Rebuilds the table for @em weights.
+     *
+     * Index i is sampled with probability weights[i] / sum of weights. Negative weights count as 0.
+     * If no weight is positive, the table is empty.
+     */
+    void setWeights(const QVector<double> &weights);
+
+    /**
+     * @brief Returns the number of weights of the table, or 0 if it is empty.
+     */
+    inline int count() const {
+        return _alias.size();
+    }
+
+    /**
+     * @brief Returns true if the table cannot be sampled.
+     */
+    inline bool isEmpty() const {
+        return _alias.isEmpty();
+    }
+
+    /**
+     * @brief Returns a random index drawn with @em random, or -1 if the table is empty.
+     */
+    int sample(SmoozikRandom &random) const;
+
+private:
+    /**
+     * @brief This property holds, for each index, the probability of keeping it rather than its alias.
+     */
+    QVector<double> _probability;
+
+    /**
+     * @brief This property holds the alias of each index.
+     */
+    QVector<int> _alias;
+};
+
+#endif // SMOOZIKRANDOM_H
@@ -0,0 +1,254 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smoozikreply.h"
+
+#include <string.h>
+
+SmoozikReply::SmoozikReply(const QString &method, const QNetworkRequest &request, const QByteArray &data, QObject *parent) :
+    QNetworkReply(parent)
+{
+    _method = method;
+    _data = data;
+    _readPosition = 0;
+    _retryCount = 0;
+    _timedOut = false;
+
+    setOperation(QNetworkAccessManager::PostOperation);
+    setRequest(request);
+    setUrl(request.url());
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+SmoozikReply::~SmoozikReply()
+{
+    // The manager deletes the network reply once it has finished, and does not forward its result to this deleted reply
+    if (_networkReply) {
+        QNetworkReply *reply = _networkReply;
+        _networkReply = 0;
+        reply->abort();
+    }
+}
+
+bool SmoozikReply::waitForFinished(int msecs)
+{
+    if (isFinished()) {
+        return true;
+    }
+
+    // The reply may be deleted by a slot connected to finished() while waiting
+    QPointer<SmoozikReply> guard(this);
+
+    QEventLoop loop;
+    connect(this, SIGNAL(finished()), &loop, SLOT(quit()));
+    QTimer timer;
+    if (msecs >= 0) {
+        timer.setSingleShot(true);
+        connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+        timer.start(msecs);
+    }
+    loop.exec(QEventLoop::ExcludeUserInputEvents);
+
+    return guard.isNull() || isFinished();
+}
+
+void SmoozikReply::abort()
+{
+    if (isFinished()) {
+        return;
+    }
+
+    if (_networkReply) {
+        _networkReply->abort();
+    }
+
+    // Network reply may not have finished synchronously, or there was no network reply yet.
+    if (!isFinished()) {
+        fail(QNetworkReply::OperationCanceledError, tr("Operation canceled"));
+    }
+}
+
+qint64 SmoozikReply::bytesAvailable() const
+{
+    return _content.size() - _readPosition + QNetworkReply::bytesAvailable();
+}
+
+qint64 SmoozikReply::readData(char *data, qint64 maxSize)
+{
+    qint64 size = qMin(maxSize, _content.size() - _readPosition);
+    if (size <= 0) {
+        return isFinished() ? -1 : 0;
+    }
+
+    memcpy(data, _content.constData() + _readPosition, size);
+    _readPosition += size;
+    return size;
+}
+
+void SmoozikReply::setNetworkReply(QNetworkReply *reply)
+{
+    _networkReply = reply;
+    connect(reply, SIGNAL(readyRead()), this, SLOT(networkReplyReadyRead()));
+}
+
+void SmoozikReply::networkReplyReadyRead()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (reply && reply == _networkReply) {
+        // Compressed content is only readable once complete
+        if (isDeflated(reply)) {
+            _encodedContent += reply->readAll();
+        } else {
+            appendContent(reply->readAll());
+        }
+    }
+}
+
+bool SmoozikReply::isDeflated(const QNetworkReply *reply) const
+{
+    return request().rawHeader("Accept-Encoding") == "deflate" && reply->rawHeader("Content-Encoding").trimmed().toLower() == "deflate";
+}
+
+QByteArray SmoozikReply::inflate(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return QByteArray("");
+    }
+
+    // qUncompress expects the uncompressed size in a 4 bytes big-endian header. It is only used as initial buffer size.
+    quint32 expectedSize = quint32(data.size()) * 4;
+    QByteArray zlibData;
+    zlibData.reserve(data.size() + 4);
+    zlibData.append(char(expectedSize >> 24));
+    zlibData.append(char(expectedSize >> 16));
+    zlibData.append(char(expectedSize >> 8));
+    zlibData.append(char(expectedSize));
+    zlibData.append(data);
+
+    QByteArray inflated = qUncompress(zlibData);
+    if (inflated.isEmpty()) {
+        return QByteArray();
+    }
+    return inflated;
+}
+
+void SmoozikReply::appendContent(const QByteArray &content)
+{
+    if (content.isEmpty()) {
+        return;
+    }
+    _content += content;
+    emit readyRead();
+}
+
+void SmoozikReply::complete(QNetworkReply *reply)
+{
+    bool deflated = isDeflated(reply);
+    if (deflated) {
+        _encodedContent += reply->readAll();
+        QByteArray content = inflate(_encodedContent);
+        _encodedContent.clear();
+
+        if (content.isNull()) {
+            copyMetaData(reply);
+            setError(QNetworkReply::ProtocolFailure, tr("Could not decompress response"));
+            finish();
+            return;
+        }
+        appendContent(content);
+    } else {
+        appendContent(reply->readAll());
+    }
+    copyMetaData(reply);
+
+    // Headers describing the encoded body do not apply to the content read from the SmoozikReply
+    if (deflated) {
+        setRawHeader("Content-Encoding", QByteArray());
+        setRawHeader("Content-Length", QByteArray());
+    }
+    finish();
+}
+
+void SmoozikReply::completeFrom(const SmoozikReply *leader)
+{
+    appendContent(leader->_content);
+    copyMetaData(leader);
+    finish();
+}
+
+void SmoozikReply::completeLater(const SmoozikReply *source)
+{
+    _content += source->_content;
+    copyMetaData(source);
+    QMetaObject::invokeMethod(this, "finishLater", Qt::QueuedConnection);
+}
+
+void SmoozikReply::copyMetaData(const QNetworkReply *reply)
+{
+    setUrl(reply->url());
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, reply->attribute(QNetworkRequest::HttpStatusCodeAttribute));
+    setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute));
+
+    foreach(const QByteArray &header, reply->rawHeaderList()) {
+        setRawHeader(header, reply->rawHeader(header));
+    }
+
+    setError(reply->error(), reply->errorString());
+}
+
+void SmoozikReply::fail(QNetworkReply::NetworkError code, const QString &errorString)
+{
+    setError(code, errorString);
+    finish();
+}
+
+void SmoozikReply::failLater(QNetworkReply::NetworkError code, const QString &errorString)
+{
+    setError(code, errorString);
+    QMetaObject::invokeMethod(this, "finish", Qt::QueuedConnection);
+}
+
+void SmoozikReply::finishLater()
+{
+    if (isFinished()) {
+        return;
+    }
+
+    if (!_content.isEmpty()) {
+        emit readyRead();
+    }
+    finish();
+}
+
+void SmoozikReply::finish()
+{
+    if (isFinished()) {
+        return;
+    }
+
+    setFinished(true);
+    emit metaDataChanged();
+    QNetworkReply::NetworkError code = error();
+    if (code != QNetworkReply::NoError) {
+        emit error(code);
+    }
+    emit readChannelFinished();
+    emit finished();
+}
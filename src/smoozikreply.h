@@ -0,0 +1,215 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKREPLY_H
+#define SMOOZIKREPLY_H
+
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QEventLoop>
+#include <QTimer>
+
+#include "global.h"
+
+class SmoozikManager;
+
+/**
+ * @brief The SmoozikReply class is the handle of a single request sent with SmoozikManager.
+ *
+ * A SmoozikReply is returned as soon as the request is sent and behaves as any QNetworkReply: connect to its finished() signal to be notified of completion,
+ * then read the server response with readAll() or give it to SmoozikXml::parse().
+ * The underlying network reply is owned by the SmoozikReply and may be replaced during the request lifetime, so only the SmoozikReply should be kept.
+ */
+class SMOOZIKLIB_EXPORT SmoozikReply : public QNetworkReply
+{
+    Q_OBJECT
+    /**
+     * @brief This property holds the API method requested.
+     * @af method()
+     * @pm _method
+     */
+    Q_PROPERTY(QString method READ method)
+
+public:
+    ~SmoozikReply();
+
+    inline QString method() const {
+        return _method;
+    } /**< @see #method */
+
+    /**
+     * @brief Waits until this request is finished or @em msecs milliseconds have passed.
+     *
+     * Only the completion of this very request ends the wait, other requests of the manager go on in the background.
+     * User input events are not processed while waiting.
+     * @param msecs Deadline in milliseconds. A negative value means no deadline.
+     * @retval true if the request is finished.
+     * @retval false if the deadline was reached first.
+     */
+    bool waitForFinished(int msecs = -1);
+
+    /**
+     * @brief Aborts the request.
+     *
+     * The reply finishes immediately with QNetworkReply::OperationCanceledError.
+     */
+    void abort();
+
+    qint64 bytesAvailable() const;
+
+    /**
+     * @brief Returns the number of times the request was sent again after a network failure.
+     * @see SmoozikManager::maxRetries()
+     */
+    inline int retryCount() const {
+        return _retryCount;
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize);
+
+private:
+    /**
+     * @brief Constructs a SmoozikReply for @em method. Replies are only created by SmoozikManager.
+     * @param method The requested method
+     * @param request Signed request to send
+     * @param data Encoded POST data to send
+     * @param parent
+     */
+    explicit SmoozikReply(const QString &method, const QNetworkRequest &request, const QByteArray &data, QObject *parent = 0);
+
+    QString _method; /**< @see #method */
+    /**
+     * @brief This property holds the encoded POST data sent with the request.
+     */
+    QByteArray _data;
+    /**
+     * @brief This property holds the network reply currently serving the request.
+     */
+    QPointer<QNetworkReply> _networkReply;
+    /**
+     * @brief This property holds the content received so far.
+     */
+    QByteArray _content;
+    /**
+     * @brief This property holds the position of the next byte of #_content to be read.
+     */
+    qint64 _readPosition;
+    int _retryCount; /**< @see retryCount() */
+    /**
+     * @brief This property holds whether the request was aborted by SmoozikManager because it reached SmoozikManager#timeout.
+     */
+    bool _timedOut;
+    /**
+     * @brief This property holds the compressed content received so far. It is decompressed to #_content once complete.
+     */
+    QByteArray _encodedContent;
+    /**
+     * @brief This property holds the key of the response in SmoozikManager cache, empty if the response is not cached.
+     */
+    QByteArray _cacheKey;
+
+    /**
+     * @brief Attaches the network reply serving the request.
+     *
+     * The network reply stays owned by the SmoozikManager which sent it. It is aborted if the SmoozikReply is deleted before it finishes.
+     */
+    void setNetworkReply(QNetworkReply *reply);
+
+    /**
+     * @brief Returns true if any data of the response was received.
+     */
+    inline bool hasReceivedData() const {
+        return !_content.isEmpty() || !_encodedContent.isEmpty();
+    }
+
+    /**
+     * @brief Returns true if the content of @em reply is compressed with deflate encoding and left for the SmoozikReply to decompress.
+     *
+     * That is only the case when the request asked for it with its own "Accept-Encoding: deflate" header, see SmoozikManager#acceptCompressedResponses.
+     * Otherwise, Qt negotiated the encoding and already decompressed the content, although the Content-Encoding header is kept.
+     */
+    bool isDeflated(const QNetworkReply *reply) const;
+
+    /**
+     * @brief Returns @em data decompressed from zlib format, or a null array if it could not be decompressed.
+     */
+    static QByteArray inflate(const QByteArray &data);
+
+    /**
+     * @brief Appends @em content to the received content and notifies readers.
+     */
+    void appendContent(const QByteArray &content);
+
+    /**
+     * @brief Finishes the SmoozikReply with the result of network reply @em reply.
+     */
+    void complete(QNetworkReply *reply);
+
+    /**
+     * @brief Finishes the SmoozikReply with the result of @em leader, a finished SmoozikReply for an identical request.
+     */
+    void completeFrom(const SmoozikReply *leader);
+
+    /**
+     * @brief Takes the content and meta data of @em source, a finished SmoozikReply, and finishes once control returns to the event loop.
+     *
+     * Used to answer requests from cache.
+     */
+    void completeLater(const SmoozikReply *source);
+
+    /**
+     * @brief Copies url, status, headers and error of @em reply.
+     */
+    void copyMetaData(const QNetworkReply *reply);
+
+    /**
+     * @brief Finishes the SmoozikReply with error @em code without any content.
+     */
+    void fail(QNetworkReply::NetworkError code, const QString &errorString);
+
+    /**
+     * @brief Sets error @em code and finishes the SmoozikReply once control returns to the event loop.
+     *
+     * Used to fail requests before the caller had a chance to connect to finished().
+     */
+    void failLater(QNetworkReply::NetworkError code, const QString &errorString);
+
+    friend class SmoozikManager;
+
+private slots:
+    /**
+     * @brief Marks the SmoozikReply as finished and emits related signals.
+     */
+    void finish();
+
+    /**
+     * @brief Notifies readers of the content taken by completeLater() and finishes.
+     */
+    void finishLater();
+
+    /**
+     * @brief Moves data available in the network reply to #_content.
+     */
+    void networkReplyReadyRead();
+};
+
+#endif // SMOOZIKREPLY_H
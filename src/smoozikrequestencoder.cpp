@@ -0,0 +1,224 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smoozikrequestencoder.h"
+
+namespace
+{
+/**
+ * @brief Walks a map of parameters merged with a map of fixed parameters which take precedence.
+ */
+class ParameterCursor
+{
+public:
+    ParameterCursor(const QMap<QString, QString> &params, const QMap<QString, QString> &fixedParams) :
+        _it(params.constBegin()), _end(params.constEnd()), _fixedIt(fixedParams.constBegin()), _fixedEnd(fixedParams.constEnd()) {
+    }
+
+    inline bool atEnd() const {
+        return _it == _end && _fixedIt == _fixedEnd;
+    }
+
+    /** Current key. Must not be called at end. */
+    inline const QString &key() const {
+        if (_fixedIt == _fixedEnd || (_it != _end && _it.key() < _fixedIt.key())) {
+            return _it.key();
+        }
+        return _fixedIt.key();
+    }
+
+    /** Returns the value of @em key if it is the current key, and moves to the next key. */
+    inline const QString *take(const QString &key) {
+        const QString *value = 0;
+        if (_fixedIt != _fixedEnd && _fixedIt.key() == key) {
+            value = &_fixedIt.value();
+            ++_fixedIt;
+            if (_it != _end && _it.key() == key) {
+                ++_it;
+            }
+        } else if (_it != _end && _it.key() == key) {
+            value = &_it.value();
+            ++_it;
+        }
+        return value;
+    }
+
+private:
+    QMap<QString, QString>::const_iterator _it;
+    QMap<QString, QString>::const_iterator _end;
+    QMap<QString, QString>::const_iterator _fixedIt;
+    QMap<QString, QString>::const_iterator _fixedEnd;
+};
+}
+
+SmoozikRequestEncoder::SmoozikRequestEncoder() :
+    _hash(QCryptographicHash::Md5)
+{
+    _unsignedPostSize = 0;
+    _getData.reserve(256);
+    _postData.reserve(1024);
+    _key.reserve(64);
+    _getValue.reserve(256);
+    _postValue.reserve(256);
+}
+
+void SmoozikRequestEncoder::setFixedGetParameter(const QString &key, const QString &value)
+{
+    _fixedGetParams.insert(key, value);
+}
+
+void SmoozikRequestEncoder::setFixedPostParameter(const QString &key, const QString &value)
+{
+    _fixedPostParams.insert(key, value);
+}
+
+void SmoozikRequestEncoder::encode(const QMap<QString, QString> &getParams, const QMap<QString, QString> &postParams, const QString &secret)
+{
+    _getData.resize(0);
+    _postData.resize(0);
+    _hash.reset();
+
+    static const QString sigKey("sig");
+    static const QString empty;
+
+    ParameterCursor get(getParams, _fixedGetParams);
+    ParameterCursor post(postParams, _fixedPostParams);
+
+    while (!get.atEnd() || !post.atEnd()) {
+        // Copy the key as taking it moves the cursor
+        QString key;
+        if (post.atEnd() || (!get.atEnd() && get.key() < post.key())) {
+            key = get.key();
+        } else {
+            key = post.key();
+        }
+
+        const QString *getValue = get.take(key);
+        const QString *postValue = post.take(key);
+        if (!getValue) {
+            getValue = &empty;
+        }
+        if (!postValue) {
+            postValue = &empty;
+        }
+
+        int count = (getValue->isEmpty() ? 0 : 1) + (postValue->isEmpty() ? 0 : 1);
+        if (count == 0) {
+            continue;
+        }
+
+        toUtf8(key, _key);
+        toUtf8(*getValue, _getValue);
+        toUtf8(*postValue, _postValue);
+
+        if (!getValue->isEmpty()) {
+            appendParameter(_key, _getValue, _getData);
+        }
+        if (!postValue->isEmpty()) {
+            appendParameter(_key, _postValue, _postData);
+        }
+
+        // A key sent through both methods is signed twice
+        if (key != sigKey) {
+            for (int i = 0; i < count; i++) {
+                _hash.addData(_key.constData(), _key.size());
+                _hash.addData(_getValue.constData(), _getValue.size());
+                _hash.addData(_postValue.constData(), _postValue.size());
+            }
+        }
+    }
+
+    toUtf8(secret, _key);
+    _hash.addData(_key.constData(), _key.size());
+    _signature = _hash.result().toHex();
+
+    _unsignedPostSize = _postData.size();
+    if (!_postData.isEmpty()) {
+        _postData.append('&');
+    }
+    _postData.append("sig=");
+    _postData.append(_signature);
+}
+
+void SmoozikRequestEncoder::toUtf8(const QString &string, QByteArray &buffer)
+{
+    buffer.resize(string.size() * 3);
+    uchar *out = reinterpret_cast<uchar *>(buffer.data());
+    const ushort *in = string.utf16();
+    const ushort *end = in + string.size();
+
+    while (in < end) {
+        uint c = *in++;
+        if (c < 0x80) {
+            *out++ = c;
+        } else if (c < 0x800) {
+            *out++ = 0xc0 | (c >> 6);
+            *out++ = 0x80 | (c & 0x3f);
+        } else if (QChar::isHighSurrogate(c) && in < end && QChar::isLowSurrogate(*in)) {
+            c = QChar::surrogateToUcs4(c, *in++);
+            *out++ = 0xf0 | (c >> 18);
+            *out++ = 0x80 | ((c >> 12) & 0x3f);
+            *out++ = 0x80 | ((c >> 6) & 0x3f);
+            *out++ = 0x80 | (c & 0x3f);
+        } else if (QChar::isHighSurrogate(c) || QChar::isLowSurrogate(c)) {
+            *out++ = '?';
+        } else {
+            *out++ = 0xe0 | (c >> 12);
+            *out++ = 0x80 | ((c >> 6) & 0x3f);
+            *out++ = 0x80 | (c & 0x3f);
+        }
+    }
+
+    buffer.resize(out - reinterpret_cast<uchar *>(buffer.data()));
+}
+
+void SmoozikRequestEncoder::appendPercentEncoded(const QByteArray &data, QByteArray &buffer)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    int size = buffer.size();
+    buffer.resize(size + data.size() * 3);
+    char *out = buffer.data() + size;
+    const uchar *in = reinterpret_cast<const uchar *>(data.constData());
+    const uchar *end = in + data.size();
+
+    while (in < end) {
+        uchar c = *in++;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~') {
+            *out++ = c;
+        } else {
+            *out++ = '%';
+            *out++ = hex[c >> 4];
+            *out++ = hex[c & 0xf];
+        }
+    }
+
+    buffer.resize(out - buffer.constData());
+}
+
+void SmoozikRequestEncoder::appendParameter(const QByteArray &key, const QByteArray &value, QByteArray &buffer)
+{
+    if (!buffer.isEmpty()) {
+        buffer.append('&');
+    }
+    appendPercentEncoded(key, buffer);
+    buffer.append('=');
+    appendPercentEncoded(value, buffer);
+}
@@ -0,0 +1,132 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKREQUESTENCODER_H
+#define SMOOZIKREQUESTENCODER_H
+
+#include <QMap>
+#include <QString>
+#include <QByteArray>
+#include <QCryptographicHash>
+
+#include "global.h"
+
+/**
+ * @brief The SmoozikRequestEncoder class signs and encodes parameters of Smoozik API requests.
+ *
+ * GET and POST parameters are walked once, in key order. The same walk feeds the MD5 signature and writes the percent-encoded GET and POST data.
+ * Parameters with an empty value are not sent. The signature is the MD5 of the concatenation, for each sent key but "sig" in key order, of the key, its GET value and its POST value, followed by the secret.
+ * The signature is appended to POST data as "sig".
+ *
+ * Buffers are kept between calls to encode(), so an encoder should be reused for successive requests. An encoder is not thread-safe.
+ */
+class SMOOZIKLIB_EXPORT SmoozikRequestEncoder
+{
+public:
+    SmoozikRequestEncoder();
+
+    /**
+     * @brief Sets a GET parameter sent with every request. It overrides any GET parameter with the same key given to encode().
+     */
+    void setFixedGetParameter(const QString &key, const QString &value);
+
+    /**
+     * @brief Sets a POST parameter sent with every request. It overrides any POST parameter with the same key given to encode().
+     */
+    void setFixedPostParameter(const QString &key, const QString &value);
+
+    /**
+     * @brief Signs and encodes @em getParams and @em postParams with the fixed parameters.
+     *
+     * Results are available with getData(), postData() and signature() until the next call.
+     * @param getParams Parameters sent through GET method
+     * @param postParams Parameters sent through POST method
+     * @param secret Secret key appended to signed data
+     */
+    void encode(const QMap<QString, QString> &getParams, const QMap<QString, QString> &postParams, const QString &secret);
+
+    /**
+     * @brief Returns a copy of the encoded GET data, without leading "?".
+     */
+    inline QByteArray getData() const {
+        return QByteArray(_getData.constData(), _getData.size());
+    }
+
+    /**
+     * @brief Returns a copy of the encoded POST data, signature included.
+     */
+    inline QByteArray postData() const {
+        return QByteArray(_postData.constData(), _postData.size());
+    }
+
+    /**
+     * @brief Returns a copy of the encoded POST data without the signature.
+     */
+    inline QByteArray unsignedPostData() const {
+        return QByteArray(_postData.constData(), _unsignedPostSize);
+    }
+
+    /**
+     * @brief Returns the hexadecimal signature.
+     */
+    inline QByteArray signature() const {
+        return _signature;
+    }
+
+    /**
+     * @brief Writes @em string encoded in UTF-8 to @em buffer, replacing its content.
+     *
+     * Unpaired surrogates are written as '?'. @em buffer keeps its capacity.
+     */
+    static void toUtf8(const QString &string, QByteArray &buffer);
+
+    /**
+     * @brief Appends @em data to @em buffer, percent-encoding any byte that is not an unreserved character of RFC 3986.
+     */
+    static void appendPercentEncoded(const QByteArray &data, QByteArray &buffer);
+
+private:
+    QMap<QString, QString> _fixedGetParams; /**< @see setFixedGetParameter() */
+    QMap<QString, QString> _fixedPostParams; /**< @see setFixedPostParameter() */
+    QByteArray _getData; /**< @see getData() */
+    QByteArray _postData; /**< @see postData() */
+    QByteArray _signature; /**< @see signature() */
+    int _unsignedPostSize; /**< @see unsignedPostData() */
+    /**
+     * @brief This property holds the key being encoded, in UTF-8.
+     */
+    QByteArray _key;
+    /**
+     * @brief This property holds the GET value being encoded, in UTF-8.
+     */
+    QByteArray _getValue;
+    /**
+     * @brief This property holds the POST value being encoded, in UTF-8.
+     */
+    QByteArray _postValue;
+    QCryptographicHash _hash; /**< @brief This property holds the signature being computed. */
+
+    /**
+     * @brief Appends "key=value" to @em buffer, preceded by "&" if @em buffer is not empty.
+     */
+    static void appendParameter(const QByteArray &key, const QByteArray &value, QByteArray &buffer);
+};
+
+#endif // SMOOZIKREQUESTENCODER_H
@@ -22,26 +22,27 @@
 #include "smoozikxml.h"
 
 SmoozikTrack::SmoozikTrack(const QString &localId, const QString &name, QObject *parent, const QString &artist, const QString &album, uint duration, const QString &fileName) :
-    QObject(parent)
+    QObject(parent),
+    _data(localId, name, artist, album, duration, fileName)
 {
-    _localId = localId;
-    _name = name;
-    _artist = artist;
-    _album = album;
-    _duration = duration;
-    _fileName = fileName;
 }
 
 SmoozikTrack::SmoozikTrack(const QDomDocument &doc, QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    _data(SmoozikTrackData::fromMap(SmoozikXml::parseElement(doc.firstChildElement()).toMap()))
 {
-    setPropertiesFromMap(SmoozikXml::parseElement(doc.firstChildElement()).toMap());
 }
 
 SmoozikTrack::SmoozikTrack(const QVariantMap &map, QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    _data(SmoozikTrackData::fromMap(map))
+{
+}
+
+SmoozikTrack::SmoozikTrack(const SmoozikTrackData &data, QObject *parent) :
+    QObject(parent),
+    _data(data)
 {
-    setPropertiesFromMap(map);
 }
 
 SmoozikTrack::~SmoozikTrack()
@@ -51,10 +52,5 @@ SmoozikTrack::~SmoozikTrack()
 
 void SmoozikTrack::setPropertiesFromMap(const QVariantMap &map)
 {
-    (map.contains("localId")) ? _localId = map["localId"].toString() : _localId = QString();
-    (map.contains("name")) ? _name = map["name"].toString() : _name = QString();
-    (map.contains("artist")) ? _artist = map["artist"].toString() : _artist = QString();
-    (map.contains("album")) ? _album = map["album"].toString() : _album = QString();
-    (map.contains("duration")) ? _duration = map["duration"].toString().toInt() : _duration = 0;
-    (map.contains("fileName")) ? _fileName = map["fileName"].toString() : _fileName = QString();
+    _data = SmoozikTrackData::fromMap(map);
 }
@@ -26,9 +26,12 @@
 #include <QDomDocument>
 
 #include "global.h"
+#include "smooziktrackdata.h"
 
 /**
  * @brief The SmoozikTrack class represents a track.
+ *
+ * It is a QObject wrapper around a SmoozikTrackData, which should be preferred to hold many tracks.
  */
 class SMOOZIKLIB_EXPORT SmoozikTrack : public QObject
 {
@@ -38,39 +41,39 @@ class SMOOZIKLIB_EXPORT SmoozikTrack : public QObject
      * This Id should allow you to identify any track in your local database.
      * This could be a path or an id given by a software inner database.
      * @af localId()
-     * @pm _localId
+     * @pm _data
      */
     Q_PROPERTY(QString localId READ localId)
     /**
      * @brief This property holds the name of the track.
      * @af name()
-     * @pm _name
+     * @pm _data
      */
     Q_PROPERTY(QString name READ name)
     /**
      * @brief This property holds the artist of the track.
      * @af artist()
-     * @pm _artist
+     * @pm _data
      */
     Q_PROPERTY(QString artist READ artist)
     /**
      * @brief This property holds the album name of the track.
      * @af album()
-     * @pm _album
+     * @pm _data
      */
     Q_PROPERTY(QString album READ album)
     /**
      * @brief This property holds the duration of the track.
      * @af duration()
-     * @pm _duration
+     * @pm _data
      */
     Q_PROPERTY(uint duration READ duration)
     /**
      * @brief This property holds the name of the file corresponding to the track.
      *
      * This property is used locally and is never sent to the server. It can be useful to retrieve a path from a localId and vice versa.
-     * @af duration()
-     * @pm _duration
+     * @af fileName()
+     * @pm _data
      */
     Q_PROPERTY(QString fileName READ fileName)
     Q_OBJECT
@@ -91,45 +94,55 @@ public:
      * @return
      */
     explicit SmoozikTrack(const QVariantMap &map, QObject *parent = 0);
+    /**
+     * @brief Constructs a SmoozikTrack holding track @em data.
+     */
+    explicit SmoozikTrack(const SmoozikTrackData &data, QObject *parent = 0);
 
     ~SmoozikTrack();
 
     inline QString localId() const {
-        return _localId;
+        return _data.localId();
     } /**< see #localId */
 
     inline QString name() const {
-        return _name;
+        return _data.name();
     } /**< see #name */
 
     inline QString artist() const {
-        return _artist;
+        return _data.artist();
     } /**< see #artist */
 
     inline QString album() const {
-        return _album;
+        return _data.album();
     } /**< see #album */
 
     inline uint duration() const {
-        return _duration;
+        return _data.duration();
     } /**< see #duration */
 
     inline QString fileName() const {
-        return _fileName;
+        return _data.fileName();
     } /**< see #fileName */
 
-private:
-    QString _localId; /**< see #localId */
-    QString _name; /**< see #name */
-    QString _artist; /**< see #artist */
-    QString _album; /**< see #album */
-    uint _duration; /**< see #duration */
-    QString _fileName; /**< see #fileName */
+    /**
+     * @brief Returns the properties of the track as a SmoozikTrackData.
+     */
+    inline const SmoozikTrackData &data() const {
+        return _data;
+    }
+
     /**
      * @brief Sets track properties with data from QVariantMap @em map.
+     *
+     * All properties are replaced: those missing from @em map are reset. This lets a track object handed out by SmoozikPlaylist be refreshed in place
+     * from a parsed response, as the QVariantMap constructor fills a new one.
      * @param map QVariantMap containing a list of track properties
      */
     void setPropertiesFromMap(const QVariantMap &map);
+
+private:
+    SmoozikTrackData _data; /**< see data() */
 };
 
 #endif // SMOOZIKTRACK_H
@@ -0,0 +1,126 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smooziktrackcatalog.h"
+#include "smoozikplaylist.h"
+
+#include <QBuffer>
+
+SmoozikTrackCatalog::SmoozikTrackCatalog() :
+    _map(0)
+{
+    // Strings are decoded on each access, so that reading never modifies the catalog
+    _snapshot.setCacheStrings(false);
+}
+
+SmoozikTrackCatalog::~SmoozikTrackCatalog()
+{
+    clear();
+}
+
+bool SmoozikTrackCatalog::load(const QString &fileName)
+{
+    clear();
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        _errorString = _file.errorString();
+        return false;
+    }
+
+    qint64 size = _file.size();
+    _map = (size > 0) ? _file.map(0, size) : 0;
+    if (_map) {
+        _data = QByteArray::fromRawData((const char *)_map, size);
+    } else {
+        _data = _file.readAll();
+        _file.close();
+    }
+
+    if (!_snapshot.open(_data)) {
+        _errorString = _snapshot.errorString();
+        clear();
+        return false;
+    }
+    buildIndex();
+    _errorString = QString();
+    return true;
+}
+
+bool SmoozikTrackCatalog::load(const SmoozikPlaylist *playlist)
+{
+    clear();
+    QBuffer buffer(&_data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!_snapshot.save(playlist, &buffer) || !_snapshot.open(_data)) {
+        _errorString = _snapshot.errorString();
+        clear();
+        return false;
+    }
+    buildIndex();
+    _errorString = QString();
+    return true;
+}
+
+void SmoozikTrackCatalog::clear()
+{
+    _snapshot.close();
+    _localIdIndex.clear();
+    _data = QByteArray();
+    if (_map) {
+        _file.unmap(_map);
+        _map = 0;
+    }
+    _file.close();
+}
+
+SmoozikTrackData SmoozikTrackCatalog::trackData(quint32 index) const
+{
+    return (index < (quint32)_snapshot.count()) ? _snapshot.trackData(index) : SmoozikTrackData();
+}
+
+QString SmoozikTrackCatalog::localId(quint32 index) const
+{
+    return (index < (quint32)_snapshot.count()) ? _snapshot.localId(index) : QString();
+}
+
+QString SmoozikTrackCatalog::fileName(quint32 index) const
+{
+    return (index < (quint32)_snapshot.count()) ? _snapshot.fileName(index) : QString();
+}
+
+QByteArray SmoozikTrackCatalog::fileNameBytes(quint32 index) const
+{
+    return (index < (quint32)_snapshot.count()) ? _snapshot.fileNameBytes(index) : QByteArray();
+}
+
+int SmoozikTrackCatalog::indexOf(const QString &localId) const
+{
+    return _localIdIndex.value(localId.toUtf8(), -1);
+}
+
+void SmoozikTrackCatalog::buildIndex()
+{
+    int trackCount = _snapshot.count();
+    _localIdIndex.reserve(trackCount);
+    // Keep the first track of a localId, as SmoozikPlaylist does
+    for (int i = trackCount - 1; i >= 0; i--) {
+        _localIdIndex.insert(_snapshot.localIdBytes(i), i);
+    }
+}
@@ -0,0 +1,138 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKTRACKCATALOG_H
+#define SMOOZIKTRACKCATALOG_H
+
+#include <QFile>
+#include <QHash>
+
+#include "global.h"
+#include "smooziktrackdata.h"
+#include "smoozikplaylistsnapshot.h"
+
+class SmoozikPlaylist;
+
+/**
+ * @brief The SmoozikTrackCatalog class holds a large, read-only collection of tracks shared by several playlists.
+ *
+ * Tracks are kept in the binary format of SmoozikPlaylistSnapshot. A catalog loaded from a snapshot file keeps the file mapped in memory,
+ * so that its records are only read, and its strings only decoded, when a track is accessed. Decoded strings are not cached: the mapped UTF-8 data stays
+ * the only copy of the catalog in memory. load() builds the localId index on the raw UTF-8 bytes of the mapping.
+ * Tracks are identified by their 32-bit index in the catalog; SmoozikPlaylistView holds such indexes instead of copies of tracks.
+ *
+ * Once loaded, a catalog is never modified by reads, so it can be read from several threads without locking. It must outlive the views referring to it.
+ */
+class SMOOZIKLIB_EXPORT SmoozikTrackCatalog
+{
+public:
+    SmoozikTrackCatalog();
+    ~SmoozikTrackCatalog();
+
+    /**
+     * @brief Loads the catalog from snapshot file @em fileName, written by SmoozikPlaylist::saveSnapshot().
+     *
+     * The file is mapped in memory when the platform allows it, and read otherwise.
+     * @retval true if the catalog was loaded.
+     * @retval false otherwise. The catalog is empty and the error is accessible with errorString().
+     */
+    bool load(const QString &fileName);
+
+    /**
+     * @brief Loads the catalog from the tracks of @em playlist.
+     *
+     * Tracks are stored in snapshot format in memory, so that the playlist can be deleted afterwards.
+     */
+    bool load(const SmoozikPlaylist *playlist);
+
+    /**
+     * @brief Empties the catalog, unmapping its file if any.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the error of the last call to load(), or a null string if it succeeded.
+     */
+    inline QString errorString() const {
+        return _errorString;
+    }
+
+    /**
+     * @brief Returns the number of tracks of the catalog.
+     */
+    inline int count() const {
+        return _snapshot.count();
+    }
+
+    /**
+     * @brief Returns true if the catalog has no track.
+     */
+    inline bool isEmpty() const {
+        return _snapshot.count() == 0;
+    }
+
+    /**
+     * @brief Returns track @em index, or a null track if @em index is out of range.
+     */
+    SmoozikTrackData trackData(quint32 index) const;
+
+    /**
+     * @brief Returns the localId of track @em index, or a null string if @em index is out of range.
+     */
+    QString localId(quint32 index) const;
+
+    /**
+     * @brief Returns the fileName of track @em index, or a null string if @em index is out of range.
+     */
+    QString fileName(quint32 index) const;
+
+    /**
+     * @brief Returns the UTF-8 fileName of track @em index without decoding nor copying it, or a null array if @em index is out of range.
+     *
+     * The array refers to the catalog data and is only valid until the catalog is cleared or loaded again.
+     */
+    QByteArray fileNameBytes(quint32 index) const;
+
+    /**
+     * @brief Returns the index of the track with @em localId, or -1 if the catalog has none.
+     */
+    int indexOf(const QString &localId) const;
+
+private:
+    Q_DISABLE_COPY(SmoozikTrackCatalog)
+
+    /**
+     * @brief This property holds the error of the last call to load().
+     */
+    QString _errorString;
+
+    QFile _file; /**< Mapped snapshot file */
+    uchar *_map; /**< Mapping of #_file, or 0 */
+    QByteArray _data; /**< Snapshot data, raw data of #_map if the file is mapped */
+    SmoozikPlaylistSnapshot _snapshot; /**< Reader of #_data */
+    QHash<QByteArray, int> _localIdIndex; /**< UTF-8 localIds referring to #_data, @see indexOf() */
+
+    /**
+     * @brief Builds #_localIdIndex from the opened snapshot.
+     */
+    void buildIndex();
+};
+
+#endif // SMOOZIKTRACKCATALOG_H
@@ -0,0 +1,70 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smooziktrackdata.h"
+
+SmoozikTrackData::SmoozikTrackData() :
+    d(new SmoozikTrackDataPrivate)
+{
+}
+
+SmoozikTrackData::SmoozikTrackData(const QString &localId, const QString &name, const QString &artist, const QString &album, uint duration, const QString &fileName) :
+    d(new SmoozikTrackDataPrivate)
+{
+    d->localId = localId;
+    d->name = name;
+    d->artist = artist;
+    d->album = album;
+    d->duration = duration;
+    d->fileName = fileName;
+}
+
+SmoozikTrackData SmoozikTrackData::fromMap(const QVariantMap &map)
+{
+    SmoozikTrackData track(map.value("localId").toString(), map.value("name").toString());
+    QVariantMap::const_iterator it = map.constFind("artist");
+    if (it != map.constEnd()) {
+        track.d->artist = it.value().toString();
+    }
+    it = map.constFind("album");
+    if (it != map.constEnd()) {
+        track.d->album = it.value().toString();
+    }
+    it = map.constFind("duration");
+    if (it != map.constEnd()) {
+        track.d->duration = it.value().toString().toInt();
+    }
+    it = map.constFind("fileName");
+    if (it != map.constEnd()) {
+        track.d->fileName = it.value().toString();
+    }
+    return track;
+}
+
+bool SmoozikTrackData::operator==(const SmoozikTrackData &other) const
+{
+    return d == other.d
+           || (d->localId == other.d->localId
+               && d->name == other.d->name
+               && d->artist == other.d->artist
+               && d->album == other.d->album
+               && d->duration == other.d->duration
+               && d->fileName == other.d->fileName);
+}
@@ -0,0 +1,159 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKTRACKDATA_H
+#define SMOOZIKTRACKDATA_H
+
+#include <QString>
+#include <QVariantMap>
+#include <QSharedData>
+#include <QSharedDataPointer>
+#include <QMetaType>
+
+#include "global.h"
+
+/**
+ * @brief The SmoozikTrackDataPrivate class holds the properties of a SmoozikTrackData.
+ */
+class SmoozikTrackDataPrivate : public QSharedData
+{
+public:
+    SmoozikTrackDataPrivate() : duration(0) {}
+    QString localId; /**< see SmoozikTrackData::localId() */
+    QString name; /**< see SmoozikTrackData::name() */
+    QString artist; /**< see SmoozikTrackData::artist() */
+    QString album; /**< see SmoozikTrackData::album() */
+    uint duration; /**< see SmoozikTrackData::duration() */
+    QString fileName; /**< see SmoozikTrackData::fileName() */
+};
+
+/**
+ * @brief The SmoozikTrackData class represents a track as an implicitly shared value.
+ *
+ * Unlike SmoozikTrack, it is not a QObject: copying it only increments a reference count, and big track collections do not pay for a QObject per track.
+ * SmoozikPlaylist stores its tracks as SmoozikTrackData. SmoozikTrack wraps a SmoozikTrackData for compatibility.
+ */
+class SMOOZIKLIB_EXPORT SmoozikTrackData
+{
+public:
+    /**
+     * @brief Constructs a null track.
+     */
+    SmoozikTrackData();
+    SmoozikTrackData(const QString &localId, const QString &name, const QString &artist = QString(), const QString &album = QString(), uint duration = 0, const QString &fileName = QString());
+
+    /**
+     * @brief Returns a track with properties from QVariantMap @em map.
+     * @param map QVariantMap containing a list of track properties, as parsed with SmoozikXml
+     */
+    static SmoozikTrackData fromMap(const QVariantMap &map);
+
+    /**
+     * @brief Returns true if the track has no localId.
+     */
+    inline bool isNull() const {
+        return d->localId.isNull();
+    }
+
+    /**
+     * @brief Returns the local unique Id of the track.
+     * @see SmoozikTrack::localId
+     */
+    inline QString localId() const {
+        return d->localId;
+    }
+
+    inline void setLocalId(const QString &localId) {
+        d->localId = localId;
+    } /**< see localId() */
+
+    /**
+     * @brief Returns the name of the track.
+     */
+    inline QString name() const {
+        return d->name;
+    }
+
+    inline void setName(const QString &name) {
+        d->name = name;
+    } /**< see name() */
+
+    /**
+     * @brief Returns the artist of the track.
+     */
+    inline QString artist() const {
+        return d->artist;
+    }
+
+    inline void setArtist(const QString &artist) {
+        d->artist = artist;
+    } /**< see artist() */
+
+    /**
+     * @brief Returns the album name of the track.
+     */
+    inline QString album() const {
+        return d->album;
+    }
+
+    inline void setAlbum(const QString &album) {
+        d->album = album;
+    } /**< see album() */
+
+    /**
+     * @brief Returns the duration of the track.
+     */
+    inline uint duration() const {
+        return d->duration;
+    }
+
+    inline void setDuration(uint duration) {
+        d->duration = duration;
+    } /**< see duration() */
+
+    /**
+     * @brief Returns the name of the file corresponding to the track.
+     * @see SmoozikTrack::fileName
+     */
+    inline QString fileName() const {
+        return d->fileName;
+    }
+
+    inline void setFileName(const QString &fileName) {
+        d->fileName = fileName;
+    } /**< see fileName() */
+
+    /**
+     * @brief Returns true if all properties of both tracks are equal.
+     */
+    bool operator==(const SmoozikTrackData &other) const;
+
+    inline bool operator!=(const SmoozikTrackData &other) const {
+        return !(*this == other);
+    }
+
+private:
+    QSharedDataPointer<SmoozikTrackDataPrivate> d;
+};
+
+Q_DECLARE_TYPEINFO(SmoozikTrackData, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(SmoozikTrackData)
+
+#endif // SMOOZIKTRACKDATA_H
@@ -0,0 +1,177 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smooziktracktable.h"
+#include "smoozikplaylist.h"
+
+SmoozikTrackTable::SmoozikTrackTable()
+{
+    clear();
+}
+
+SmoozikTrackTable::SmoozikTrackTable(const SmoozikPlaylist *playlist)
+{
+    clear();
+    append(playlist);
+}
+
+void SmoozikTrackTable::append(const QString &localId, const QString &name, const QString &artist, const QString &album, uint duration, const QString &fileName)
+{
+    _columns[LocalId].append(addString(localId, false));
+    _columns[Name].append(addString(name, false));
+    _columns[Artist].append(addString(artist, true));
+    _columns[Album].append(addString(album, true));
+    _columns[FileName].append(addString(fileName, false));
+    _durations.append(duration);
+}
+
+void SmoozikTrackTable::append(const SmoozikPlaylist *playlist)
+{
+    int size = playlist->size();
+    reserve(count() + size);
+    for (int i = 0; i < size; i++) {
+        append(playlist->trackData(i));
+    }
+}
+
+void SmoozikTrackTable::reserve(int size)
+{
+    for (int column = 0; column < ColumnCount; column++) {
+        _columns[column].reserve(size);
+    }
+    _durations.reserve(size);
+}
+
+void SmoozikTrackTable::clear()
+{
+    // Resizing keeps capacity, so that a table refilled with a new library stops allocating
+    _pool.resize(0);
+    _strings.resize(0);
+    _interned.clear();
+    for (int column = 0; column < ColumnCount; column++) {
+        _columns[column].resize(0);
+    }
+    _durations.resize(0);
+
+    Span empty;
+    empty.offset = 0;
+    empty.length = 0;
+    _strings.append(empty);
+}
+
+int SmoozikTrackTable::addString(const QString &value, bool intern)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+
+    if (intern) {
+        int id = internedId(value);
+        if (id > 0) {
+            return id;
+        }
+    }
+
+    Span span;
+    span.offset = _pool.size();
+    span.length = value.size();
+    _pool.append(value);
+    int id = _strings.size();
+    _strings.append(span);
+    if (intern) {
+        _interned.insert(qHash(value), id);
+    }
+    return id;
+}
+
+int SmoozikTrackTable::internedId(const QString &value) const
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+
+    uint hash = qHash(value);
+    QMultiHash<uint, int>::const_iterator it = _interned.constFind(hash);
+    while (it != _interned.constEnd() && it.key() == hash) {
+        const Span &span = _strings.at(it.value());
+        if (QStringRef(&_pool, span.offset, span.length) == value) {
+            return it.value();
+        }
+        ++it;
+    }
+    return -1;
+}
+
+QVector<int> SmoozikTrackTable::find(Column column, const QString &value) const
+{
+    QVector<int> rows;
+    const int *ids = _columns[column].constData();
+    int rowCount = count();
+
+    if (column == Artist || column == Album || value.isEmpty()) {
+        // Interned values and empty strings are compared by id
+        int id = internedId(value);
+        if (id < 0) {
+            return rows;
+        }
+        for (int row = 0; row < rowCount; row++) {
+            if (ids[row] == id) {
+                rows.append(row);
+            }
+        }
+        return rows;
+    }
+
+    int length = value.size();
+    const Span *spans = _strings.constData();
+    for (int row = 0; row < rowCount; row++) {
+        const Span &span = spans[ids[row]];
+        if (span.length == length && QStringRef(&_pool, span.offset, span.length) == value) {
+            rows.append(row);
+        }
+    }
+    return rows;
+}
+
+quint64 SmoozikTrackTable::totalDuration() const
+{
+    quint64 total = 0;
+    const uint *durations = _durations.constData();
+    int rowCount = count();
+    for (int row = 0; row < rowCount; row++) {
+        total += durations[row];
+    }
+    return total;
+}
+
+SmoozikTrackData SmoozikTrackTable::trackData(int row) const
+{
+    return SmoozikTrackData(localId(row).toString(), name(row).toString(), artist(row).toString(), album(row).toString(), duration(row), fileName(row).toString());
+}
+
+SmoozikPlaylist *SmoozikTrackTable::toPlaylist(QObject *parent) const
+{
+    SmoozikPlaylist *playlist = new SmoozikPlaylist(parent);
+    int rowCount = count();
+    for (int row = 0; row < rowCount; row++) {
+        playlist->addTrack(trackData(row));
+    }
+    return playlist;
+}
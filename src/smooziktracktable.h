@@ -0,0 +1,236 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKTRACKTABLE_H
+#define SMOOZIKTRACKTABLE_H
+
+#include <QString>
+#include <QVector>
+#include <QMultiHash>
+
+#include "global.h"
+#include "smooziktrackdata.h"
+
+class SmoozikPlaylist;
+
+/**
+ * @brief The SmoozikTrackTable class stores a large collection of tracks in columns.
+ *
+ * Each track is a row. Durations are stored in a contiguous array, and each string property in a contiguous array of ids into a single string pool.
+ * Artist and album names are interned, so that all tracks of an artist share the same id and can be found by comparing integers.
+ * Scanning a column, as find() and totalDuration() do, thus reads contiguous memory instead of following a pointer per track.
+ *
+ * Rows are accessed without creating any object. trackData() and toPlaylist() convert rows to the usual track types when needed.
+ */
+class SMOOZIKLIB_EXPORT SmoozikTrackTable
+{
+public:
+    /**
+     * @brief The Column enum lists the string properties of a track.
+     */
+    enum Column {
+        LocalId = 0, /**< see SmoozikTrack::localId */
+        Name, /**< see SmoozikTrack::name */
+        Artist, /**< see SmoozikTrack::artist, interned */
+        Album, /**< see SmoozikTrack::album, interned */
+        FileName, /**< see SmoozikTrack::fileName */
+        ColumnCount /**< Number of string columns */
+    };
+
+    SmoozikTrackTable();
+    /**
+     * @brief Constructs a SmoozikTrackTable and fills it with the tracks of @em playlist.
+     */
+    explicit SmoozikTrackTable(const SmoozikPlaylist *playlist);
+
+    /**
+     * @brief Appends a row for @em track.
+     *
+     * Unlike SmoozikPlaylist, the table does not check that localIds are unique.
+     */
+    inline void append(const SmoozikTrackData &track) {
+        append(track.localId(), track.name(), track.artist(), track.album(), track.duration(), track.fileName());
+    }
+
+    /**
+     * @brief Appends a row for a track.
+     * @param localId Local unique Id of the track
+     * @param name Name of the track
+     * @param artist Artist of the track
+     * @param album Album name of the track
+     * @param duration Duration of the track
+     * @param fileName Name of the file corresponding to the track
+     */
+    void append(const QString &localId, const QString &name, const QString &artist = QString(), const QString &album = QString(), uint duration = 0, const QString &fileName = QString());
+
+    /**
+     * @brief Appends a row for each track of @em playlist.
+     */
+    void append(const SmoozikPlaylist *playlist);
+
+    /**
+     * @brief Reserves space for @em size rows.
+     */
+    void reserve(int size);
+
+    /**
+     * @brief Removes all rows. Buffers are kept to be reused.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of rows.
+     */
+    inline int count() const {
+        return _durations.size();
+    }
+
+    /**
+     * @brief Returns true if the table has no row.
+     */
+    inline bool isEmpty() const {
+        return _durations.isEmpty();
+    }
+
+    /**
+     * @brief Returns the value of @em column for @em row, or a null reference if it is empty.
+     *
+     * The reference is valid until the table is cleared.
+     */
+    inline QStringRef value(int row, Column column) const {
+        const Span &span = _strings.at(_columns[column].at(row));
+        return span.length ? QStringRef(&_pool, span.offset, span.length) : QStringRef();
+    }
+
+    inline QStringRef localId(int row) const {
+        return value(row, LocalId);
+    } /**< see value() */
+
+    inline QStringRef name(int row) const {
+        return value(row, Name);
+    } /**< see value() */
+
+    inline QStringRef artist(int row) const {
+        return value(row, Artist);
+    } /**< see value() */
+
+    inline QStringRef album(int row) const {
+        return value(row, Album);
+    } /**< see value() */
+
+    inline QStringRef fileName(int row) const {
+        return value(row, FileName);
+    } /**< see value() */
+
+    inline uint duration(int row) const {
+        return _durations.at(row);
+    } /**< see SmoozikTrack::duration */
+
+    /**
+     * @brief Returns the durations of all rows as a contiguous array of count() values.
+     */
+    inline const uint *durations() const {
+        return _durations.constData();
+    }
+
+    /**
+     * @brief Returns the string id of @em column for @em row.
+     *
+     * Id 0 is the empty string. For interned columns, rows with the same value have the same id.
+     */
+    inline int stringId(int row, Column column) const {
+        return _columns[column].at(row);
+    }
+
+    /**
+     * @brief Returns the string ids of @em column for all rows as a contiguous array of count() values.
+     */
+    inline const int *stringIds(Column column) const {
+        return _columns[column].constData();
+    }
+
+    /**
+     * @brief Returns the id of interned string @em value, 0 if it is empty, or -1 if no Artist or Album has this value.
+     */
+    int internedId(const QString &value) const;
+
+    /**
+     * @brief Returns the rows whose @em column is @em value, in ascending order.
+     */
+    QVector<int> find(Column column, const QString &value) const;
+
+    /**
+     * @brief Returns the sum of the durations of all rows.
+     */
+    quint64 totalDuration() const;
+
+    /**
+     * @brief Returns @em row as a SmoozikTrackData.
+     */
+    SmoozikTrackData trackData(int row) const;
+
+    /**
+     * @brief Returns a new playlist filled with the tracks of the table.
+     *
+     * As in SmoozikPlaylist::addTrack(), rows with a localId already added are skipped.
+     */
+    SmoozikPlaylist *toPlaylist(QObject *parent = 0) const;
+
+private:
+    /**
+     * @brief The Span struct locates a string in #_pool.
+     */
+    struct Span {
+        int offset; /**< Offset of the string in #_pool */
+        int length; /**< Length of the string */
+    };
+
+    /**
+     * @brief Adds @em value to the pool, or finds it if @em intern is true and it has already been interned, and returns its id.
+     */
+    int addString(const QString &value, bool intern);
+
+    /**
+     * @brief This property holds the characters of all strings.
+     */
+    QString _pool;
+
+    /**
+     * @brief This property holds the strings of the pool by id. Id 0 is the empty string.
+     */
+    QVector<Span> _strings;
+
+    /**
+     * @brief This property holds the ids of interned strings, by string hash.
+     */
+    QMultiHash<uint, int> _interned;
+
+    /**
+     * @brief This property holds the string ids of each column, by row.
+     */
+    QVector<int> _columns[ColumnCount];
+
+    /**
+     * @brief This property holds the duration of each row.
+     */
+    QVector<uint> _durations;
+};
+
+#endif // SMOOZIKTRACKTABLE_H
@@ -20,16 +20,27 @@
 
 #include "smoozikxml.h"
 
+/**
+ * @brief Null element returned by reference when an element is not found.
+ */
+static const QVariant nullVariant;
+
 SmoozikXml::SmoozikXml(QObject *parent) :
     QObject(parent)
 {
-    cleanError();
+    _lazy = false;
+    _dataPending = false;
+    _depth = 0;
+    reset();
 }
 
 SmoozikXml::SmoozikXml(QNetworkReply *reply, QObject *parent) :
     QObject(parent)
 {
-    cleanError();
+    _lazy = false;
+    _dataPending = false;
+    _depth = 0;
+    reset();
     parse(reply);
 }
 
@@ -42,96 +53,596 @@ void SmoozikXml::parse(const QDomElement &dataElement)
 {
     cleanError();
 
-    _parsed = parseElement(dataElement);
+    setParsed(parseElement(dataElement));
 }
 
 bool SmoozikXml::parse(QNetworkReply *reply)
 {
-    cleanError();
+    reset();
+    addData(readReply(reply));
+    reply->deleteLater();
+    return finish();
+}
+
+const QByteArray &SmoozikXml::readReply(QNetworkReply *reply)
+{
+    qint64 size = reply->bytesAvailable();
+    _buffer.resize(size);
+    size = reply->read(_buffer.data(), size);
+    _buffer.resize(qMax(size, (qint64) 0));
+    return _buffer;
+}
+
+void SmoozikXml::startParse(QNetworkReply *reply)
+{
+    reset();
+    _reply = reply;
+    connect(reply, SIGNAL(readyRead()), this, SLOT(replyReadyRead()));
+    connect(reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+
+    // Reply may already be finished, parse it once the caller had a chance to connect to parseFinished()
+    if (reply->isFinished()) {
+        QMetaObject::invokeMethod(this, "replyFinished", Qt::QueuedConnection);
+    }
+}
 
-    QByteArray xmlReply = reply->readAll();
+void SmoozikXml::replyReadyRead()
+{
+    if (_reply && sender() == _reply) {
+        addData(readReply(_reply));
+    }
+}
+
+void SmoozikXml::replyFinished()
+{
+    if (!_reply || (sender() && sender() != _reply)) {
+        return;
+    }
+
+    QNetworkReply *reply = _reply;
+    _reply = 0;
+    disconnect(reply, 0, this, 0);
+    addData(readReply(reply));
     reply->deleteLater();
-    if (xmlReply.isEmpty()) {
+    emit parseFinished(finish());
+}
+
+void SmoozikXml::reset()
+{
+    cleanError();
+    if (_reply) {
+        disconnect(_reply, 0, this, 0);
+        _reply = 0;
+    }
+    setParsed(QVariant());
+    resetReader();
+}
+
+void SmoozikXml::resetReader()
+{
+    _reader.clear();
+    _reader.setNamespaceProcessing(false);
+    for (int i = 0; i < _depth; i++) {
+        _elements[i].children.clear();
+    }
+    _depth = 0;
+    _received = false;
+    _done = false;
+    _smoozikFound = false;
+    _statusFound = false;
+    _errorFound = false;
+    _dataFound = false;
+    _skipDepth = 0;
+    _status.clear();
+    _errorElement = QVariant();
+    if (_names.count() > SmoozikXmlNameTable::MaxCount) {
+        _names.clear();
+    }
+}
+
+void SmoozikXml::addData(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+
+    if (_done) {
+        // Remaining data is only needed to decode the data element later
+        if (_dataPending) {
+            _rawData.append(data);
+        }
+        return;
+    }
+
+    // First data of a new response
+    if (!_received) {
+        cleanError();
+        setParsed(QVariant());
+        _received = true;
+    }
+    if (_lazy) {
+        _rawData.append(data);
+    }
+    _reader.addData(data);
+    readTokens();
+}
+
+void SmoozikXml::readTokens()
+{
+    while (!_done && !_reader.atEnd()) {
+        QXmlStreamReader::TokenType token = _reader.readNext();
+
+        // Data element skipped in lazy mode
+        if (_skipDepth > 0) {
+            if (token == QXmlStreamReader::StartElement) {
+                _skipDepth++;
+            } else if (token == QXmlStreamReader::EndElement) {
+                _skipDepth--;
+            }
+            continue;
+        }
+
+        switch (token) {
+        case QXmlStreamReader::StartElement: {
+            QString name = _names.name(_names.intern(_reader.qualifiedName()));
+            if (_depth == 0) {
+                _smoozikFound = (name == "smoozik");
+            } else {
+                addNodeChild();
+            }
+
+            // In lazy mode, data element is decoded on first access
+            if (_lazy && _smoozikFound && _depth == 1 && name == "data" && !_dataFound) {
+                _dataFound = true;
+                _dataPending = true;
+                _skipDepth = 1;
+                if (_statusFound && _status != "failed") {
+                    _done = true;
+                }
+                break;
+            }
+
+            // Elements are recycled from one response to another
+            if (_depth == _elements.size()) {
+                _elements.append(Element());
+            }
+            Element &element = _elements[_depth++];
+            element.name = name;
+            element.isText = false;
+            element.hasFirstChild = false;
+            element.textOpen = false;
+            element.text.clear();
+            break;
+        }
+        case QXmlStreamReader::EndElement: {
+            Element &element = _elements[--_depth];
+            // Children of smoozik element are not kept, only the envelope is
+            if (_depth == 1) {
+                envelopeElementParsed(element.name, elementValue(element));
+            } else if (_depth > 1) {
+                Element &parent = _elements[_depth - 1];
+                if (!parent.isText) {
+                    parent.children.append(qMakePair(element.name, elementValue(element)));
+                }
+            }
+            element.children.clear();
+            break;
+        }
+        case QXmlStreamReader::Characters:
+            // Whitespace-only text is ignored, as by QDomDocument
+            if (_depth > 0 && !_reader.isWhitespace()) {
+                addTextChild(_reader.text(), _reader.isCDATA());
+            }
+            break;
+        case QXmlStreamReader::Comment:
+        case QXmlStreamReader::ProcessingInstruction:
+            if (_depth > 0) {
+                addNodeChild();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void SmoozikXml::addNodeChild()
+{
+    Element &element = _elements[_depth - 1];
+    element.textOpen = false;
+    if (!element.hasFirstChild) {
+        element.hasFirstChild = true;
+        element.isText = false;
+    }
+}
+
+void SmoozikXml::addTextChild(const QStringRef &text, bool isCDATA)
+{
+    Element &element = _elements[_depth - 1];
+    // Reader may split a text node in several tokens, a CDATA section is a node of its own
+    if (element.textOpen && !isCDATA) {
+        element.text.append(text);
+    } else if (!element.hasFirstChild) {
+        element.hasFirstChild = true;
+        element.isText = true;
+        element.textOpen = !isCDATA;
+        element.text = text.toString();
+    } else {
+        element.textOpen = false;
+    }
+}
+
+QVariant SmoozikXml::elementValue(const Element &element)
+{
+    QVariant variant;
+    // Case when element is text
+    if (element.isText) {
+        variant.setValue(element.text);
+        return variant;
+    }
+
+    //Case when element is an array (there is another element with same tag in list or item name is singular of parent name
+    QString firstName = element.children.isEmpty() ? QString() : element.children.first().first;
+    bool isList = (element.name == firstName + "s");
+    for (int i = 1; !isList && i < element.children.size(); i++) {
+        isList = (element.children.at(i).first == firstName);
+    }
+
+    if (isList) {
+        QVariantList list;
+        for (int i = 0; i < element.children.size(); i++) {
+            QVariantMap map;
+            map[element.children.at(i).first] = element.children.at(i).second;
+            list.append(map);
+        }
+        variant.setValue(list);
+        return variant;
+    }
+
+    //Case when element is not an array
+    QVariantMap map;
+    for (int i = 0; i < element.children.size(); i++) {
+        map[element.children.at(i).first] = element.children.at(i).second;
+    }
+    variant.setValue(map);
+    return variant;
+}
+
+void SmoozikXml::envelopeElementParsed(const QString &name, const QVariant &value)
+{
+    if (!_smoozikFound) {
+        return;
+    }
+
+    if (name == "status" && !_statusFound) {
+        _statusFound = true;
+        _status = value.toString();
+    } else if (name == "error" && !_errorFound) {
+        _errorFound = true;
+        _errorElement = value;
+    } else if (name == "data" && !_dataFound) {
+        _dataFound = true;
+        setParsed(value);
+    }
+
+    // A failed response is known as soon as its status and error are
+    if (_statusFound && _status == "failed" && _errorFound) {
+        _done = true;
+    }
+
+    // A successful response is known as soon as its status is, when its data is decoded lazily
+    if (_statusFound && _status != "failed" && _dataPending) {
+        _done = true;
+    }
+}
+
+bool SmoozikXml::finish()
+{
+    bool success = checkResponse();
+    resetReader();
+    return success;
+}
+
+bool SmoozikXml::checkResponse()
+{
+    cleanError();
+
+    if (!_received) {
         _error = SmoozikManager::ServerUnreachable;
         _errorMsg = tr("Could not reach server.");
         return false;
     }
 
-    // Parse xml
-    QDomDocument xml;
-    QString errorMsg;
-    int errorLine;
-    int errorColumn;
-    if (!xml.setContent(xmlReply, &errorMsg, &errorLine, &errorColumn)) {
+    if (!_done && (_reader.hasError() || _depth > 0 || !_reader.atEnd())) {
+        QString errorMsg = _reader.hasError() ? _reader.errorString() : tr("unexpected end of file");
         _error = SmoozikManager::ParseError;
-        _errorMsg = tr("Could not parse xml : %1 (line: %2, column: %3).").arg(errorMsg).arg(errorLine).arg(errorColumn);
+        _errorMsg = tr("Could not parse xml : %1 (line: %2, column: %3).").arg(errorMsg).arg(_reader.lineNumber()).arg(_reader.columnNumber());
+        setParsed(QVariant());
         return false;
     }
 
-    QDomElement smoozikElement = xml.firstChildElement("smoozik");
-    if (smoozikElement.isNull()) {
+    if (!_smoozikFound) {
         _error = SmoozikManager::ParseError;
         _errorMsg = tr("Could not parse xml : %1 element is missing.").arg("smoozik");
+        setParsed(QVariant());
         return false;
     }
 
-    QDomElement statusElement = smoozikElement.firstChildElement("status");
-    if (statusElement.isNull()) {
+    if (!_statusFound) {
         _error = SmoozikManager::ParseError;
         _errorMsg = tr("Could not parse xml : %1 element is missing.").arg("status");
+        setParsed(QVariant());
         return false;
     }
 
-    if (statusElement.text() == "failed") {
+    if (_status == "failed") {
+        setParsed(QVariant());
 
-        QDomElement errorElement = smoozikElement.firstChildElement("error");
-        if (errorElement.isNull()) {
+        if (!_errorFound) {
             _error = SmoozikManager::ParseError;
             _errorMsg = tr("Could not parse xml : %1 element is missing.").arg("failed");
             return false;
         }
 
-        QDomElement codeElement = errorElement.firstChildElement("code");
-        if (codeElement.isNull()) {
+        QVariantMap errorMap = _errorElement.toMap();
+        if (!errorMap.contains("code")) {
             _error = SmoozikManager::ParseError;
             _errorMsg = tr("Could not parse xml : %1 element is missing.").arg("code");
             return false;
         }
 
-        int code = codeElement.text().toInt();
-        QDomElement messageElement = errorElement.firstChildElement("message");
-        QString message = messageElement.text();
+        _error = (SmoozikManager::Error)errorMap["code"].toString().toInt();
+        _errorMsg = errorMap["message"].toString();
+        return false;
+    }
+
+    if (!_dataFound) {
+        _error = SmoozikManager::ParseError;
+        _errorMsg = tr("Could not parse xml : %1 element is missing.").arg("data");
+        return false;
+    }
+
+    return true;
+}
+
+SmoozikPlaylist *SmoozikXml::parseTracks(QNetworkReply *reply, QObject *parent)
+{
+    const QByteArray &data = readReply(reply);
+    reply->deleteLater();
+    return parseTracks(data, parent);
+}
+
+SmoozikPlaylist *SmoozikXml::parseTracks(const QByteArray &data, QObject *parent)
+{
+    reset();
+
+    if (data.isEmpty()) {
+        _error = SmoozikManager::ServerUnreachable;
+        _errorMsg = tr("Could not reach server.");
+        return 0;
+    }
+
+    QXmlStreamReader reader(data);
+    reader.setNamespaceProcessing(false);
+    SmoozikPlaylist *playlist = new SmoozikPlaylist(parent);
+    if (!readTracks(reader, playlist)) {
+        delete playlist;
+        return 0;
+    }
+    return playlist;
+}
+
+bool SmoozikXml::readTracks(QXmlStreamReader &reader, SmoozikPlaylist *playlist)
+{
+    bool smoozikFound = false;
+    bool statusFound = false;
+    bool errorFound = false;
+    bool dataFound = false;
+    QString status;
+    QString code;
+    QString message;
+
+    if (reader.readNextStartElement() && reader.qualifiedName() == QLatin1String("smoozik")) {
+        smoozikFound = true;
+        while (reader.readNextStartElement()) {
+            QStringRef name = reader.qualifiedName();
+            if (name == QLatin1String("status")) {
+                status = reader.readElementText(QXmlStreamReader::SkipChildElements);
+                statusFound = true;
+            } else if (name == QLatin1String("error")) {
+                errorFound = true;
+                while (reader.readNextStartElement()) {
+                    if (reader.qualifiedName() == QLatin1String("code")) {
+                        code = reader.readElementText(QXmlStreamReader::SkipChildElements);
+                    } else if (reader.qualifiedName() == QLatin1String("message")) {
+                        message = reader.readElementText(QXmlStreamReader::SkipChildElements);
+                    } else {
+                        reader.skipCurrentElement();
+                    }
+                }
+            } else if (name == QLatin1String("data") && status != "failed") {
+                dataFound = true;
+                while (reader.readNextStartElement()) {
+                    if (reader.qualifiedName() != QLatin1String("tracks")) {
+                        reader.skipCurrentElement();
+                        continue;
+                    }
+                    while (reader.readNextStartElement()) {
+                        if (reader.qualifiedName() == QLatin1String("track")) {
+                            readTrack(reader, playlist);
+                        } else {
+                            reader.skipCurrentElement();
+                        }
+                    }
+                }
+            } else {
+                reader.skipCurrentElement();
+            }
+
+            // Failed responses are known as soon as their error is read
+            if (status == "failed" && errorFound) {
+                break;
+            }
+        }
+    }
+
+    bool failed = (status == "failed" && errorFound);
+    if (!failed && reader.hasError()) {
+        _error = SmoozikManager::ParseError;
+        _errorMsg = tr("Could not parse xml : %1 (line: %2, column: %3).").arg(reader.errorString()).arg(reader.lineNumber()).arg(reader.columnNumber());
+        return false;
+    }
+
+    if (!smoozikFound) {
+        _error = SmoozikManager::ParseError;
+        _errorMsg = tr("Could not parse xml : %1 element is missing.").arg("smoozik");
+        return false;
+    }
+
+    if (!statusFound) {
+        _error = SmoozikManager::ParseError;
+        _errorMsg = tr("Could not parse xml : %1 element is missing.").arg("status");
+        return false;
+    }
+
+    if (status == "failed") {
+        if (!errorFound) {
+            _error = SmoozikManager::ParseError;
+            _errorMsg = tr("Could not parse xml : %1 element is missing.").arg("failed");
+            return false;
+        }
+
+        if (code.isNull()) {
+            _error = SmoozikManager::ParseError;
+            _errorMsg = tr("Could not parse xml : %1 element is missing.").arg("code");
+            return false;
+        }
 
-        _error = (SmoozikManager::Error)code;
+        _error = (SmoozikManager::Error)code.toInt();
         _errorMsg = message;
         return false;
     }
 
-    QDomElement dataElement = smoozikElement.firstChildElement("data");
-    if (dataElement.isNull()) {
+    if (!dataFound) {
         _error = SmoozikManager::ParseError;
         _errorMsg = tr("Could not parse xml : %1 element is missing.").arg("data");
         return false;
     }
 
-    parse(dataElement);
     return true;
 }
 
-QVariant SmoozikXml::operator [](const QString &key) const
+void SmoozikXml::readTrack(QXmlStreamReader &reader, SmoozikPlaylist *playlist)
+{
+    QString localId;
+    QString name;
+    QString artist;
+    QString album;
+    uint duration = 0;
+    QString fileName;
+
+    while (reader.readNextStartElement()) {
+        QStringRef field = reader.qualifiedName();
+        QString *value = 0;
+        if (field == QLatin1String("localId")) {
+            value = &localId;
+        } else if (field == QLatin1String("name")) {
+            value = &name;
+        } else if (field == QLatin1String("artist")) {
+            value = &artist;
+        } else if (field == QLatin1String("album")) {
+            value = &album;
+        } else if (field == QLatin1String("fileName")) {
+            value = &fileName;
+        } else if (field == QLatin1String("duration")) {
+            duration = reader.readElementText(QXmlStreamReader::SkipChildElements).toInt();
+            continue;
+        } else {
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        // Whitespace only text is ignored, as in parseElement()
+        *value = reader.readElementText(QXmlStreamReader::SkipChildElements);
+        if (value->trimmed().isEmpty()) {
+            value->clear();
+        }
+    }
+
+    playlist->addTrack(localId, name, artist, album, duration, fileName);
+}
+
+void SmoozikXml::print(QTextStream &stream) const
+{
+    decodeData();
+    printVariant(stream, _parsed, 0);
+}
+
+void SmoozikXml::print(QIODevice *device) const
+{
+    QTextStream stream(device);
+    stream.setCodec("UTF-8");
+    print(stream);
+}
+
+void SmoozikXml::printJsonLine(QTextStream &stream) const
+{
+    decodeData();
+    stream << "{\"error\":" << (int) _error;
+    if (_error != SmoozikManager::NoError) {
+        stream << ",\"errorMsg\":";
+        writeJsonString(stream, _errorMsg);
+    }
+    if (!_parsed.isNull()) {
+        stream << ",\"data\":";
+        printJson(stream, _parsed);
+    }
+    stream << "}\n";
+}
+
+const QVariant &SmoozikXml::operator [](const QString &key) const
+{
+    decodeData();
+    return child(_parsed, key);
+}
+
+const QVariant &SmoozikXml::operator [](const int i) const
+{
+    decodeData();
+    return child(_parsed, i);
+}
+
+const QVariant &SmoozikXml::value(const QString &path) const
 {
-    if (!_parsed.toMap().isEmpty()) {
-        return _parsed.toMap()[key];
+    decodeData();
+    QHash<QString, const QVariant *>::const_iterator it = _pathIndex.constFind(path);
+    if (it != _pathIndex.constEnd()) {
+        return *it.value();
     }
-    return QVariant();
+
+    const QVariant &value = find(_parsed, path);
+    _pathIndex.insert(path, &value);
+    return value;
 }
 
-QVariant SmoozikXml::operator [](const int i) const
+void SmoozikXml::setParsed(const QVariant &parsed)
 {
-    if (!_parsed.toList().isEmpty()) {
-        return _parsed.toList().value(i);
+    _parsed = parsed;
+    _pathIndex.clear();
+    _dataPending = false;
+    _rawData.clear();
+}
+
+void SmoozikXml::decodePendingData()
+{
+    if (!_tree.parse(_rawData)) {
+        _error = SmoozikManager::ParseError;
+        _errorMsg = tr("Could not parse xml : %1.").arg(_tree.errorString());
+        setParsed(QVariant());
+        return;
     }
-    return QVariant();
+    setParsed(_tree.toVariant(_tree.child(_tree.root(), "data")));
+    _tree.clear();
 }
 
 QVariant SmoozikXml::parseElement(const QDomElement &element)
@@ -171,33 +682,181 @@ QVariant SmoozikXml::parseElement(const QDomElement &element)
 QString SmoozikXml::printVariant(const QVariant &variant, const int indentCount)
 {
     QString res;
-    QString tab = "    ";
-    QString indent;
+    QTextStream stream(&res);
+    printVariant(stream, variant, indentCount);
+    stream.flush();
+    return res;
+}
+
+void SmoozikXml::printVariant(QTextStream &stream, const QVariant &variant, int indentCount)
+{
+    switch (variant.type()) {
+    case QVariant::List: {
+        const QVariantList *list = static_cast<const QVariantList *>(variant.constData());
+        if (list->isEmpty()) {
+            stream << '\n';
+            return;
+        }
+        stream << "{\n";
+        for (QVariantList::const_iterator it = list->constBegin(); it != list->constEnd(); ++it) {
+            writeIndent(stream, indentCount + 1);
+            printVariant(stream, *it, indentCount + 1);
+        }
+        writeIndent(stream, indentCount);
+        stream << "}\n";
+        return;
+    }
+    case QVariant::Map: {
+        const QVariantMap *map = static_cast<const QVariantMap *>(variant.constData());
+        if (map->isEmpty()) {
+            stream << '\n';
+            return;
+        }
+        stream << "{\n";
+        for (QVariantMap::const_iterator it = map->constBegin(); it != map->constEnd(); ++it) {
+            writeIndent(stream, indentCount + 1);
+            stream << it.key() << " : ";
+            printVariant(stream, it.value(), indentCount + 1);
+        }
+        writeIndent(stream, indentCount);
+        stream << "}\n";
+        return;
+    }
+    default:
+        stream << variant.toString() << '\n';
+        return;
+    }
+}
+
+void SmoozikXml::writeIndent(QTextStream &stream, int indentCount)
+{
     for (int i = 0; i < indentCount; i++) {
-        indent += tab;
+        stream << "    ";
     }
+}
 
-    if (!variant.toString().isEmpty()) {
-        res = variant.toString() + "\n";
-    } else if (!variant.toList().isEmpty()) {
-        res += "{\n";
+void SmoozikXml::printJson(QTextStream &stream, const QVariant &variant)
+{
+    switch (variant.type()) {
+    case QVariant::Invalid:
+        stream << "null";
+        return;
+    case QVariant::List: {
+        const QVariantList *list = static_cast<const QVariantList *>(variant.constData());
+        stream << '[';
+        for (QVariantList::const_iterator it = list->constBegin(); it != list->constEnd(); ++it) {
+            if (it != list->constBegin()) {
+                stream << ',';
+            }
+            printJson(stream, *it);
+        }
+        stream << ']';
+        return;
+    }
+    case QVariant::Map: {
+        const QVariantMap *map = static_cast<const QVariantMap *>(variant.constData());
+        stream << '{';
+        for (QVariantMap::const_iterator it = map->constBegin(); it != map->constEnd(); ++it) {
+            if (it != map->constBegin()) {
+                stream << ',';
+            }
+            writeJsonString(stream, it.key());
+            stream << ':';
+            printJson(stream, it.value());
+        }
+        stream << '}';
+        return;
+    }
+    default:
+        writeJsonString(stream, variant.toString());
+        return;
+    }
+}
 
-        foreach(QVariant child, variant.toList()) {
-            res += indent + tab + printVariant(child, indentCount + 1);
+void SmoozikXml::writeJsonString(QTextStream &stream, const QString &string)
+{
+    stream << '"';
+    const QChar *data = string.constData();
+    int length = string.length();
+    int start = 0;
+    for (int i = 0; i < length; i++) {
+        ushort c = data[i].unicode();
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
         }
-        res += indent + "}\n";
-    } else if (!variant.toMap().isEmpty()) {
-        res += "{\n";
 
-        foreach(QString key, variant.toMap().keys()) {
-            res += indent + tab + key + " : " + printVariant(variant.toMap()[key], indentCount + 1);
+        // Characters needing no escape are written in runs
+        if (i > start) {
+            stream << QString::fromRawData(data + start, i - start);
+        }
+        start = i + 1;
+        switch (c) {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        case '\r':
+            stream << "\\r";
+            break;
+        case '\t':
+            stream << "\\t";
+            break;
+        default:
+            stream << QString("\\u%1").arg(c, 4, 16, QChar('0'));
+            break;
         }
-        res += indent + "}\n";
-    } else {
-        res = "\n";
     }
+    if (length > start) {
+        stream << QString::fromRawData(data + start, length - start);
+    }
+    stream << '"';
+}
 
-    return res;
+const QVariant &SmoozikXml::child(const QVariant &variant, const QString &key)
+{
+    // Elements are read in place: QVariant::toMap() would return a copy of the map
+    if (variant.type() == QVariant::Map) {
+        const QVariantMap *map = static_cast<const QVariantMap *>(variant.constData());
+        QVariantMap::const_iterator it = map->constFind(key);
+        if (it != map->constEnd()) {
+            return it.value();
+        }
+    }
+    return nullVariant;
+}
+
+const QVariant &SmoozikXml::child(const QVariant &variant, int i)
+{
+    if (variant.type() == QVariant::List) {
+        const QVariantList *list = static_cast<const QVariantList *>(variant.constData());
+        if (i >= 0 && i < list->size()) {
+            return list->at(i);
+        }
+    }
+    return nullVariant;
+}
+
+const QVariant &SmoozikXml::find(const QVariant &variant, const QString &path)
+{
+    const QVariant *current = &variant;
+    foreach(const QString &key, path.split('/', QString::SkipEmptyParts)) {
+        bool isIndex = false;
+        int i = key.toInt(&isIndex);
+        if (isIndex && current->type() == QVariant::List) {
+            current = &child(*current, i);
+        } else {
+            current = &child(*current, key);
+        }
+        if (current->isNull()) {
+            break;
+        }
+    }
+    return *current;
 }
 
 void SmoozikXml::cleanError()
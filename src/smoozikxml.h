@@ -23,11 +23,22 @@
 
 #include <QObject>
 #include <QDomDocument>
+#include <QXmlStreamReader>
+#include <QPointer>
+#include <QVector>
+#include <QTextStream>
 
 #include "smoozikmanager.h"
+#include "smoozikxmltree.h"
 
 /**
  * @brief The SmoozikXml class provides with functions to parse XML response from Smoozik webserver
+ *
+ * Responses are parsed in a single pass with a QXmlStreamReader, without building a DOM document.
+ * They can be parsed at once with parse(), or incrementally as data arrives with startParse() or addData() and finish().
+ *
+ * A parser keeps its buffers and element storage from one response to another, so a parser should be reused for successive responses.
+ * SmoozikXmlPool shares parsers between threads.
  */
 class SMOOZIKLIB_EXPORT SmoozikXml : public QObject
 {
@@ -47,6 +58,21 @@ class SMOOZIKLIB_EXPORT SmoozikXml : public QObject
      * @pm _errorMsg
      */
     Q_PROPERTY(QString errorMsg READ errorMsg)
+    /**
+     * @brief This property holds wether the data of responses is decoded lazily.
+     *
+     * In lazy mode, the smoozik, status and error elements are checked while parsing, but the data element is only decoded
+     * the first time parsed data is accessed, e.g. with operator[].
+     * Parsing stops as soon as the status is known to be successful and the data element starts,
+     * so that calls only checking the status do not pay for their data.
+     * The data element is then not checked by parse() or finish(): if it turns out to be malformed,
+     * parsed data is empty and error() is set to SmoozikManager::ParseError once it is accessed.
+     *
+     * Default value is false.
+     * @af isLazy(), setLazy()
+     * @pm _lazy
+     */
+    Q_PROPERTY(bool lazy READ isLazy WRITE setLazy)
     Q_OBJECT
 
 public:
@@ -59,6 +85,13 @@ public:
 
     ~SmoozikXml();
 
+    /**
+     * @brief Drops parsed data and error, keeping buffers for the next response.
+     */
+    inline void clear() {
+        reset();
+    }
+
     inline SmoozikManager::Error error() const {
         return _error;
     } /**< @see #error */
@@ -67,6 +100,14 @@ public:
         return _errorMsg;
     } /**< @see #errorMsg */
 
+    inline bool isLazy() const {
+        return _lazy;
+    } /**< @see #lazy */
+
+    inline void setLazy(bool lazy) {
+        _lazy = lazy;
+    } /**< @see #lazy */
+
     /**
      * @brief Parses a QDomElement data to fill SmoozikXml QMap.
      * @param dataElement a QDomElement
@@ -83,6 +124,46 @@ public:
      */
     bool parse(QNetworkReply *reply);
 
+    /**
+     * @brief Parses @em reply incrementally as data arrives, and emits parseFinished() once @em reply is finished.
+     *
+     * The reply is deleted once parsed.
+     * @param reply Response from Smoozik Server
+     */
+    void startParse(QNetworkReply *reply);
+
+    /**
+     * @brief Parses the next chunk of a response.
+     *
+     * Parsing stops as soon as the response is known to be an error.
+     * Call finish() once the whole response has been given.
+     */
+    void addData(const QByteArray &data);
+
+    /**
+     * @brief Ends parsing of a response given with addData().
+     * @retval true if parsing succeeded. Data is accessible with operator [].
+     * @retval false if parsing failed. Error is accessible with error().
+     */
+    bool finish();
+
+    /**
+     * @brief Parses a getTopTracks response from Smoozik Server directly into a new playlist.
+     *
+     * Tracks are read from the \<tracks\> element of the response data without building any intermediate QVariant.
+     * The reply is deleted during the process.
+     * @param reply Response from Smoozik Server
+     * @param parent Parent of the returned playlist
+     * @return The playlist, or 0 if parsing failed. Error is accessible with error().
+     */
+    SmoozikPlaylist *parseTracks(QNetworkReply *reply, QObject *parent = 0);
+
+    /**
+     * @brief Parses getTopTracks response @em data directly into a new playlist.
+     * @overload
+     */
+    SmoozikPlaylist *parseTracks(const QByteArray &data, QObject *parent = 0);
+
     /**
      * @brief Parses a Dom element and returns it in a QVariant.
      *
@@ -96,8 +177,9 @@ public:
      * This element might either be a QString (accessible through QVariant::toString()),
      * a QList (accessible through QVariant::toList())
      * or a QMap (accessible through QVariant::toMap()).
+     * The element is returned by reference, without copying #_parsed.
      */
-    QVariant operator[] (const QString &key) const;
+    const QVariant &operator[] (const QString &key) const;
 
     /**
      * @brief Returns the element at index position @em i of #_parsed if #_parsed is a QList.
@@ -105,13 +187,23 @@ public:
      * This element might either be a QString (accessible through QVariant::toString()),
      * a QList (accessible through QVariant::toList())
      * or a QMap (accessible through QVariant::toMap()).
+     * The element is returned by reference, without copying #_parsed.
+     */
+    const QVariant &operator[] (const int i) const;
+
+    /**
+     * @brief Returns the element at @em path of #_parsed, or a null QVariant if there is no such element.
+     *
+     * A path is a list of map keys and list indexes separated by '/', e.g. "party/code" or "tracks/3/track/name".
+     * The element is returned by reference, and found paths are indexed so that a path is only walked once per response.
      */
-    QVariant operator[] (const int i) const;
+    const QVariant &value(const QString &path) const;
 
     /**
      * @brief if _parsed is a QString, return this string; else returns an empty string.
      */
     inline QString parsedString() const {
+        decodeData();
         return _parsed.toString();
     }
 
@@ -120,9 +212,27 @@ public:
      * @return A structured string
      */
     inline QString print() const {
+        decodeData();
         return printVariant(_parsed, 0);
     }
 
+    /**
+     * @brief Writes the structured string returned by print() to @em stream, without building it in memory.
+     */
+    void print(QTextStream &stream) const;
+
+    /**
+     * @brief Writes the structured string returned by print() to @em device, in UTF-8.
+     */
+    void print(QIODevice *device) const;
+
+    /**
+     * @brief Writes the result of the last parsed response to @em stream as a single line of JSON, e.g. for log shipping.
+     *
+     * The line is an object holding "error", plus "errorMsg" if the response failed and "data" if it has data.
+     */
+    void printJsonLine(QTextStream &stream) const;
+
     /**
      * @brief Returns a structured string of variant.
      *
@@ -133,6 +243,43 @@ public:
      */
     static QString printVariant(const QVariant &variant, const int indentCount = 0);
 
+    /**
+     * @brief Writes the structured string of @em variant returned by printVariant() to @em stream.
+     *
+     * Output is streamed as it is produced, so printing a big response does not build its whole string nor copy its maps.
+     */
+    static void printVariant(QTextStream &stream, const QVariant &variant, int indentCount = 0);
+
+    /**
+     * @brief Writes @em variant to @em stream as compact JSON.
+     *
+     * Strings are written as JSON strings, lists as arrays, maps as objects and null variants as null.
+     */
+    static void printJson(QTextStream &stream, const QVariant &variant);
+
+    /**
+     * @brief Returns a reference to the element at @em key of @em variant if it is a QMap; otherwise returns a null QVariant.
+     */
+    static const QVariant &child(const QVariant &variant, const QString &key);
+
+    /**
+     * @brief Returns a reference to the element at index position @em i of @em variant if it is a QList; otherwise returns a null QVariant.
+     */
+    static const QVariant &child(const QVariant &variant, int i);
+
+    /**
+     * @brief Returns a reference to the element at @em path of @em variant, or a null QVariant if there is no such element.
+     * @see value()
+     */
+    static const QVariant &find(const QVariant &variant, const QString &path);
+
+signals:
+    /**
+     * @brief This signal is emitted when the reply given to startParse() is parsed.
+     * @param success true if parsing succeeded, false otherwise. Error is accessible with error().
+     */
+    void parseFinished(bool success);
+
 private:
     /**
      * @brief This property holds the QVariant containing the parsed xml.
@@ -140,11 +287,192 @@ private:
     QVariant _parsed;
     SmoozikManager::Error _error; /**< @see #error */
     QString _errorMsg; /**< @see #errorMsg */
+    bool _lazy; /**< @see #lazy */
+
+    /**
+     * @brief This property holds wether the data element of the response is still to be decoded from #_rawData.
+     */
+    bool _dataPending;
+
+    /**
+     * @brief This property holds the response in lazy mode, until its data element is decoded.
+     */
+    QByteArray _rawData;
+
+    /**
+     * @brief This property holds the depth of the data element being skipped in lazy mode, or 0.
+     */
+    int _skipDepth;
+
+    /**
+     * @brief This property holds the elements of #_parsed already found by value(), by path.
+     */
+    mutable QHash<QString, const QVariant *> _pathIndex;
+
+    /**
+     * @brief Sets #_parsed to @em parsed and clears #_pathIndex.
+     *
+     * Data still to be decoded in lazy mode is dropped.
+     */
+    void setParsed(const QVariant &parsed);
+
+    /**
+     * @brief Decodes the data element of the response if it is pending in lazy mode.
+     */
+    inline void decodeData() const {
+        if (_dataPending) {
+            const_cast<SmoozikXml *>(this)->decodePendingData();
+        }
+    }
+
+    /**
+     * @brief Decodes the data element of #_rawData into #_parsed.
+     */
+    void decodePendingData();
+
+    /**
+     * @brief The Element struct holds an element being parsed.
+     */
+    struct Element {
+        Element() : isText(false), hasFirstChild(false), textOpen(false) {}
+        QString name; /**< Tag name */
+        bool isText; /**< True if the first child of the element is text */
+        bool hasFirstChild; /**< True once the first child node was met */
+        bool textOpen; /**< True while the first child text may continue */
+        QString text; /**< Text of the first child if #isText */
+        QList<QPair<QString, QVariant> > children; /**< Parsed child elements */
+    };
+
+    /**
+     * @brief This property holds the reader of the response being parsed.
+     */
+    QXmlStreamReader _reader;
+
+    /**
+     * @brief This property holds the elements being parsed, the first #_depth ones being open.
+     */
+    QVector<Element> _elements;
+
+    /**
+     * @brief This property holds the number of elements of #_elements opened and not closed yet.
+     *
+     * Elements after them are kept to be recycled.
+     */
+    int _depth;
+
+    /**
+     * @brief This property holds the tag names met by this parser.
+     *
+     * It is owned by the parser so that reading an element name takes no lock, and is kept from one response to another.
+     */
+    SmoozikXmlNameTable _names;
+
+    /**
+     * @brief This property holds the buffer replies are read into.
+     */
+    QByteArray _buffer;
+
+    /**
+     * @brief This property holds the tree decoding data in lazy mode.
+     */
+    SmoozikXmlTree _tree;
+
+    /**
+     * @brief This property holds the reply given to startParse().
+     */
+    QPointer<QNetworkReply> _reply;
+
+    bool _received; /**< @brief This property holds wether any data was received. */
+    bool _done; /**< @brief This property holds wether the result of the response is known, so that remaining data is ignored. */
+    bool _smoozikFound; /**< @brief This property holds wether the root element is smoozik. */
+    bool _statusFound; /**< @brief This property holds wether the status element was parsed. */
+    bool _errorFound; /**< @brief This property holds wether the error element was parsed. */
+    bool _dataFound; /**< @brief This property holds wether the data element was parsed. */
+    QString _status; /**< @brief This property holds the content of the status element. */
+    QVariant _errorElement; /**< @brief This property holds the parsed error element. */
 
     /**
      * @brief Cleans error and error message.
      */
     void cleanError();
+
+    /**
+     * @brief Resets the parser and its result before a new response.
+     */
+    void reset();
+
+    /**
+     * @brief Resets the parser, keeping its result.
+     */
+    void resetReader();
+
+    /**
+     * @brief Computes the result of the response once it has been entirely read.
+     * @see finish()
+     */
+    bool checkResponse();
+
+    /**
+     * @brief Reads the tokens available in #_reader.
+     */
+    void readTokens();
+
+    /**
+     * @brief Writes @em indentCount indentations to @em stream.
+     */
+    static void writeIndent(QTextStream &stream, int indentCount);
+
+    /**
+     * @brief Writes @em string to @em stream as a JSON string.
+     */
+    static void writeJsonString(QTextStream &stream, const QString &string);
+
+    /**
+     * @brief Reads available data of @em reply into #_buffer and returns it.
+     */
+    const QByteArray &readReply(QNetworkReply *reply);
+
+    /**
+     * @brief Records a child node which is not text in the innermost open element.
+     */
+    void addNodeChild();
+
+    /**
+     * @brief Records text @em text in the innermost open element.
+     */
+    void addTextChild(const QStringRef &text, bool isCDATA);
+
+    /**
+     * @brief Returns the value of @em element, with the same rules as parseElement().
+     */
+    static QVariant elementValue(const Element &element);
+
+    /**
+     * @brief Handles a child of the smoozik element once it is parsed.
+     */
+    void envelopeElementParsed(const QString &name, const QVariant &value);
+
+    /**
+     * @brief Reads a whole response with @em reader and adds its tracks to @em playlist.
+     * @see parseTracks()
+     */
+    bool readTracks(QXmlStreamReader &reader, SmoozikPlaylist *playlist);
+
+    /**
+     * @brief Reads the \<track\> element @em reader is positioned on and adds it to @em playlist.
+     */
+    static void readTrack(QXmlStreamReader &reader, SmoozikPlaylist *playlist);
+
+private slots:
+    /**
+     * @brief Parses data available in the reply given to startParse().
+     */
+    void replyReadyRead();
+
+    /**
+     * @brief Ends parsing of the reply given to startParse().
+     */
+    void replyFinished();
 };
 
 #endif // SMOOZIKXML_H
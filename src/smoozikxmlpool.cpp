@@ -0,0 +1,105 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smoozikxmlpool.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+Q_GLOBAL_STATIC(SmoozikXmlPool, globalPool)
+
+SmoozikXmlPool::SmoozikXmlPool(int maxIdleCount) :
+    _maxIdleCount(maxIdleCount)
+{
+}
+
+SmoozikXmlPool::~SmoozikXmlPool()
+{
+    qDeleteAll(_idle);
+}
+
+SmoozikXml *SmoozikXmlPool::acquire()
+{
+    SmoozikXml *xml = 0;
+    {
+        QMutexLocker locker(&_mutex);
+        if (!_idle.isEmpty()) {
+            xml = _idle.takeLast();
+        }
+    }
+
+    if (!xml) {
+        return new SmoozikXml();
+    }
+
+    // Idle parsers have no thread affinity, so any thread may pull them
+    xml->moveToThread(QThread::currentThread());
+    return xml;
+}
+
+void SmoozikXmlPool::release(SmoozikXml *xml)
+{
+    if (!xml) {
+        return;
+    }
+
+    xml->clear();
+    xml->setLazy(false);
+    xml->moveToThread(0);
+
+    {
+        QMutexLocker locker(&_mutex);
+        if (_idle.size() < _maxIdleCount) {
+            _idle.append(xml);
+            return;
+        }
+    }
+    delete xml;
+}
+
+int SmoozikXmlPool::maxIdleCount() const
+{
+    QMutexLocker locker(&_mutex);
+    return _maxIdleCount;
+}
+
+void SmoozikXmlPool::setMaxIdleCount(int maxIdleCount)
+{
+    QList<SmoozikXml *> excess;
+    {
+        QMutexLocker locker(&_mutex);
+        _maxIdleCount = maxIdleCount;
+        while (_idle.size() > qMax(maxIdleCount, 0)) {
+            excess.append(_idle.takeFirst());
+        }
+    }
+    qDeleteAll(excess);
+}
+
+int SmoozikXmlPool::idleCount() const
+{
+    QMutexLocker locker(&_mutex);
+    return _idle.size();
+}
+
+SmoozikXmlPool *SmoozikXmlPool::globalInstance()
+{
+    return globalPool();
+}
@@ -0,0 +1,87 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKXMLPOOL_H
+#define SMOOZIKXMLPOOL_H
+
+#include <QList>
+#include <QMutex>
+
+#include "global.h"
+#include "smoozikxml.h"
+
+/**
+ * @brief The SmoozikXmlPool class keeps idle SmoozikXml parsers, so that threads reuse parsers and their buffers instead of creating one per response.
+ *
+ * acquire() and release() are thread-safe. A parser must be released by the thread which acquired it, and must not have a parent.
+ * Released parsers are cleared, set back to non-lazy mode and detached from any thread until they are acquired again.
+ */
+class SMOOZIKLIB_EXPORT SmoozikXmlPool
+{
+public:
+    /**
+     * @brief Constructs a pool keeping at most @em maxIdleCount idle parsers.
+     */
+    explicit SmoozikXmlPool(int maxIdleCount = 4);
+
+    /**
+     * @brief Deletes idle parsers. Parsers still acquired are not deleted.
+     */
+    ~SmoozikXmlPool();
+
+    /**
+     * @brief Returns an idle parser, or a new one if there is none. The parser belongs to the calling thread.
+     */
+    SmoozikXml *acquire();
+
+    /**
+     * @brief Gives @em xml back to the pool. It is deleted if the pool already has maxIdleCount() idle parsers.
+     */
+    void release(SmoozikXml *xml);
+
+    /**
+     * @brief Returns the maximum number of idle parsers kept by the pool.
+     */
+    int maxIdleCount() const;
+
+    /**
+     * @brief Sets the maximum number of idle parsers kept by the pool. Idle parsers in excess are deleted.
+     */
+    void setMaxIdleCount(int maxIdleCount);
+
+    /**
+     * @brief Returns the number of idle parsers.
+     */
+    int idleCount() const;
+
+    /**
+     * @brief Returns the pool shared by the whole process.
+     */
+    static SmoozikXmlPool *globalInstance();
+
+private:
+    Q_DISABLE_COPY(SmoozikXmlPool)
+
+    mutable QMutex _mutex; /**< @brief Guards #_idle and #_maxIdleCount. */
+    QList<SmoozikXml *> _idle; /**< @brief Idle parsers. */
+    int _maxIdleCount; /**< @see maxIdleCount() */
+};
+
+#endif // SMOOZIKXMLPOOL_H
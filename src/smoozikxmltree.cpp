@@ -0,0 +1,250 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "smoozikxmltree.h"
+
+#include <QXmlStreamReader>
+
+int SmoozikXmlNameTable::intern(const QStringRef &name)
+{
+    uint hash = qHash(name);
+    QMultiHash<uint, int>::const_iterator it = _ids.constFind(hash);
+    while (it != _ids.constEnd() && it.key() == hash) {
+        if (_names.at(it.value()) == name) {
+            return it.value();
+        }
+        ++it;
+    }
+
+    int id = _names.size();
+    _names.append(name.toString());
+    _ids.insert(hash, id);
+    return id;
+}
+
+int SmoozikXmlNameTable::find(const QString &name) const
+{
+    uint hash = qHash(QStringRef(&name));
+    QMultiHash<uint, int>::const_iterator it = _ids.constFind(hash);
+    while (it != _ids.constEnd() && it.key() == hash) {
+        if (_names.at(it.value()) == name) {
+            return it.value();
+        }
+        ++it;
+    }
+    return -1;
+}
+
+void SmoozikXmlNameTable::clear()
+{
+    _names.clear();
+    _ids.clear();
+}
+
+SmoozikXmlTree::SmoozikXmlTree()
+{
+}
+
+void SmoozikXmlTree::clear()
+{
+    // Resizing keeps capacity, so that a tree reused for successive responses stops allocating
+    _nodes.resize(0);
+    _text.resize(0);
+    if (_names.count() > SmoozikXmlNameTable::MaxCount) {
+        _names.clear();
+    }
+}
+
+bool SmoozikXmlTree::parse(const QByteArray &data)
+{
+    clear();
+    _errorString = QString();
+
+    // Rough estimates from Smoozik responses, to avoid growing buffers while parsing
+    if (_nodes.capacity() < data.size() / 32) {
+        _nodes.reserve(data.size() / 32);
+    }
+    if (_text.capacity() < data.size() / 2) {
+        _text.reserve(data.size() / 2);
+    }
+
+    QXmlStreamReader reader(data);
+    reader.setNamespaceProcessing(false);
+    int current = -1;
+
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            int index = _nodes.size();
+            Node node;
+            node.name = _names.intern(reader.qualifiedName());
+            node.parent = current;
+            node.firstChild = -1;
+            node.lastChild = -1;
+            node.nextSibling = -1;
+            node.childCount = 0;
+            node.textOffset = 0;
+            node.textLength = 0;
+            node.flags = 0;
+            _nodes.append(node);
+
+            if (current >= 0) {
+                addNodeChild(current);
+                Node &parent = _nodes[current];
+                if (parent.lastChild >= 0) {
+                    _nodes[parent.lastChild].nextSibling = index;
+                } else {
+                    parent.firstChild = index;
+                }
+                parent.lastChild = index;
+                parent.childCount++;
+            }
+            current = index;
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            if (current >= 0) {
+                current = _nodes.at(current).parent;
+            }
+            break;
+        case QXmlStreamReader::Characters:
+            // Whitespace-only text is ignored, as by QDomDocument
+            if (current >= 0 && !reader.isWhitespace()) {
+                addTextChild(current, reader.text(), reader.isCDATA());
+            }
+            break;
+        case QXmlStreamReader::Comment:
+        case QXmlStreamReader::ProcessingInstruction:
+            if (current >= 0) {
+                addNodeChild(current);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (reader.hasError()) {
+        _errorString = QString("%1 (line: %2, column: %3)").arg(reader.errorString()).arg(reader.lineNumber()).arg(reader.columnNumber());
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void SmoozikXmlTree::addNodeChild(int node)
+{
+    Node &n = _nodes[node];
+    n.flags &= ~TextOpen;
+    n.flags |= HasFirstChild;
+}
+
+void SmoozikXmlTree::addTextChild(int node, const QStringRef &text, bool isCDATA)
+{
+    Node &n = _nodes[node];
+    // Reader may split a text node in several tokens, a CDATA section is a node of its own.
+    // Text of a node is contiguous in _text since nothing else can be read while it is open.
+    if ((n.flags & TextOpen) && !isCDATA) {
+        _text.append(text);
+        n.textLength += text.size();
+    } else if (!(n.flags & HasFirstChild)) {
+        n.flags |= HasFirstChild | IsText;
+        if (!isCDATA) {
+            n.flags |= TextOpen;
+        }
+        n.textOffset = _text.size();
+        n.textLength = text.size();
+        _text.append(text);
+    } else {
+        n.flags &= ~TextOpen;
+    }
+}
+
+int SmoozikXmlTree::child(int node, const QString &name) const
+{
+    int id = findName(name);
+    if (id < 0) {
+        return -1;
+    }
+    for (int i = firstChild(node); i >= 0; i = nextSibling(i)) {
+        if (_nodes.at(i).name == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool SmoozikXmlTree::isList(int node) const
+{
+    if (isText(node)) {
+        return false;
+    }
+
+    // Case when item name is singular of parent name
+    int first = firstChild(node);
+    QString nodeName = name(node);
+    QString firstName = (first >= 0) ? name(first) : QString();
+    if (nodeName.size() == firstName.size() + 1 && nodeName.endsWith('s') && nodeName.startsWith(firstName)) {
+        return true;
+    }
+
+    // Case when there is another element with same tag
+    if (first >= 0) {
+        int firstId = _nodes.at(first).name;
+        for (int i = nextSibling(first); i >= 0; i = nextSibling(i)) {
+            if (_nodes.at(i).name == firstId) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+QVariant SmoozikXmlTree::toVariant(int node) const
+{
+    QVariant variant;
+    if (node < 0 || node >= _nodes.size()) {
+        return variant;
+    }
+
+    if (isText(node)) {
+        variant.setValue(text(node).toString());
+        return variant;
+    }
+
+    if (isList(node)) {
+        QVariantList list;
+        list.reserve(childCount(node));
+        for (int i = firstChild(node); i >= 0; i = nextSibling(i)) {
+            QVariantMap map;
+            map[name(i)] = toVariant(i);
+            list.append(map);
+        }
+        variant.setValue(list);
+        return variant;
+    }
+
+    QVariantMap map;
+    for (int i = firstChild(node); i >= 0; i = nextSibling(i)) {
+        map[name(i)] = toVariant(i);
+    }
+    variant.setValue(map);
+    return variant;
+}
@@ -0,0 +1,288 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMOOZIKXMLTREE_H
+#define SMOOZIKXMLTREE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QVariant>
+#include <QMultiHash>
+
+#include "global.h"
+
+/**
+ * @brief The SmoozikXmlNameTable class interns tag names, so that each name is stored once and names can be compared as integers.
+ *
+ * Names are looked up from the QStringRef returned by QXmlStreamReader, a QString being built only the first time a name is met.
+ * The table is not thread-safe: each parser owns its own.
+ */
+class SMOOZIKLIB_EXPORT SmoozikXmlNameTable
+{
+public:
+    /**
+     * @brief Number of names above which owners clear the table between responses, so that it does not grow without bound.
+     */
+    static const int MaxCount = 1024;
+
+    /**
+     * @brief Returns the id of tag name @em name, interning it if needed.
+     */
+    int intern(const QStringRef &name);
+
+    /**
+     * @brief Returns the id of tag name @em name, or -1 if it has never been interned.
+     */
+    int find(const QString &name) const;
+
+    /**
+     * @brief Returns the tag name with id @em id.
+     */
+    inline QString name(int id) const {
+        return _names.value(id);
+    }
+
+    /**
+     * @brief Returns the number of interned names.
+     */
+    inline int count() const {
+        return _names.size();
+    }
+
+    /**
+     * @brief Forgets all interned names. Ids returned so far become invalid.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief This property holds the interned names, by id.
+     */
+    QVector<QString> _names;
+
+    /**
+     * @brief This property holds the ids of interned names, by name hash.
+     */
+    QMultiHash<uint, int> _ids;
+};
+
+/**
+ * @brief The SmoozikXmlTree class holds a parsed XML response in a compact tree.
+ *
+ * All nodes of a tree are stored in a single contiguous array and refer to each other by index, the root element being node 0.
+ * Tag names are interned in a table owned by the tree and nodes only hold their id, so that names can be compared as integers.
+ * Text of all nodes is stored in a single buffer, from which text() returns slices.
+ * Parsing a response thus allocates a handful of buffers instead of a QVariant, and a map or a list, per element.
+ *
+ * toVariant() converts a node to the QVariant returned by SmoozikXml::parseElement().
+ */
+class SMOOZIKLIB_EXPORT SmoozikXmlTree
+{
+public:
+    SmoozikXmlTree();
+
+    /**
+     * @brief Parses XML document @em data, replacing the current tree.
+     * @retval true if parsing succeeded.
+     * @retval false if parsing failed. The tree is empty and the error is accessible with errorString().
+     */
+    bool parse(const QByteArray &data);
+
+    /**
+     * @brief Empties the tree. Buffers are kept to be reused by the next call to parse().
+     *
+     * Interned names are kept as well, unless there are more than SmoozikXmlNameTable::MaxCount of them.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the error of the last call to parse(), or a null string if it succeeded.
+     */
+    inline QString errorString() const {
+        return _errorString;
+    }
+
+    /**
+     * @brief Returns true if the tree has no node.
+     */
+    inline bool isEmpty() const {
+        return _nodes.isEmpty();
+    }
+
+    /**
+     * @brief Returns the number of nodes of the tree.
+     */
+    inline int count() const {
+        return _nodes.size();
+    }
+
+    /**
+     * @brief Returns the root node, or -1 if the tree is empty.
+     */
+    inline int root() const {
+        return _nodes.isEmpty() ? -1 : 0;
+    }
+
+    /**
+     * @brief Returns the interned name id of @em node.
+     */
+    inline int nameId(int node) const {
+        return _nodes.at(node).name;
+    }
+
+    /**
+     * @brief Returns the tag name of @em node.
+     */
+    inline QString name(int node) const {
+        return _names.name(_nodes.at(node).name);
+    }
+
+    /**
+     * @brief Returns true if the first child of @em node is text, that is if @em node value is a string.
+     */
+    inline bool isText(int node) const {
+        return _nodes.at(node).flags & IsText;
+    }
+
+    /**
+     * @brief Returns the text of @em node if isText(); otherwise returns a null reference.
+     *
+     * The reference is valid until the tree is cleared or parsed again.
+     */
+    inline QStringRef text(int node) const {
+        const Node &n = _nodes.at(node);
+        return (n.flags & IsText) ? QStringRef(&_text, n.textOffset, n.textLength) : QStringRef();
+    }
+
+    /**
+     * @brief Returns the parent of @em node, or -1 for the root node.
+     */
+    inline int parent(int node) const {
+        return _nodes.at(node).parent;
+    }
+
+    /**
+     * @brief Returns the first child element of @em node, or -1 if it has none.
+     */
+    inline int firstChild(int node) const {
+        return _nodes.at(node).firstChild;
+    }
+
+    /**
+     * @brief Returns the next sibling element of @em node, or -1 if it is the last child of its parent.
+     */
+    inline int nextSibling(int node) const {
+        return _nodes.at(node).nextSibling;
+    }
+
+    /**
+     * @brief Returns the number of child elements of @em node.
+     */
+    inline int childCount(int node) const {
+        return _nodes.at(node).childCount;
+    }
+
+    /**
+     * @brief Returns the first child element of @em node named @em name, or -1 if there is none.
+     */
+    int child(int node, const QString &name) const;
+
+    /**
+     * @brief Returns true if the value of @em node is a list, with the same rules as SmoozikXml::parseElement().
+     */
+    bool isList(int node) const;
+
+    /**
+     * @brief Returns the value of @em node in a QVariant, as SmoozikXml::parseElement() would.
+     */
+    QVariant toVariant(int node = 0) const;
+
+    /**
+     * @brief Returns the id of tag name @em name in this tree, or -1 if no parsed node has this name.
+     */
+    inline int findName(const QString &name) const {
+        return _names.find(name);
+    }
+
+    /**
+     * @brief Returns the tag name with id @em id in this tree.
+     */
+    inline QString internedName(int id) const {
+        return _names.name(id);
+    }
+
+private:
+    /**
+     * @brief The NodeFlag enum holds the state of a node.
+     */
+    enum NodeFlag {
+        IsText = 0x1, /**< The first child of the node is text */
+        HasFirstChild = 0x2, /**< The first child node of the node was met */
+        TextOpen = 0x4 /**< The text of the node may continue in the next token */
+    };
+
+    /**
+     * @brief The Node struct holds an element of the tree.
+     */
+    struct Node {
+        int name; /**< Interned tag name id */
+        int parent; /**< Parent node */
+        int firstChild; /**< First child element */
+        int lastChild; /**< Last child element */
+        int nextSibling; /**< Next sibling element */
+        int childCount; /**< Number of child elements */
+        int textOffset; /**< Offset of the text in #_text */
+        int textLength; /**< Length of the text in #_text */
+        int flags; /**< Combination of NodeFlag */
+    };
+
+    /**
+     * @brief This property holds the nodes of the tree.
+     */
+    QVector<Node> _nodes;
+
+    /**
+     * @brief This property holds the text of all nodes.
+     */
+    QString _text;
+
+    /**
+     * @brief This property holds the error of the last call to parse().
+     */
+    QString _errorString;
+
+    /**
+     * @brief This property holds the tag names of the nodes, kept from one call to parse() to another.
+     */
+    SmoozikXmlNameTable _names;
+
+    /**
+     * @brief Records a child node which is not text in @em node.
+     */
+    void addNodeChild(int node);
+
+    /**
+     * @brief Records text @em text in @em node.
+     */
+    void addTextChild(int node, const QStringRef &text, bool isCDATA);
+};
+
+#endif // SMOOZIKXMLTREE_H
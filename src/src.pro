@@ -16,15 +16,39 @@ VERSION = 1.0.0
 HEADERS += \
     smoozikmanager.h \
     smoozikxml.h \
+    smoozikjson.h \
+    smoozikxmltree.h \
+    smoozikxmlpool.h \
     global.h \
+    smooziktrackdata.h \
     smooziktrack.h \
-    smoozikplaylist.h
+    smoozikplaylist.h \
+    smoozikplaylistdelta.h \
+    smoozikplaylistsnapshot.h \
+    smooziktrackcatalog.h \
+    smoozikplaylistview.h \
+    smooziktracktable.h \
+    smoozikrandom.h \
+    smoozikreply.h \
+    smoozikrequestencoder.h
 
 SOURCES += \
     smoozikmanager.cpp \
     smoozikxml.cpp \
+    smoozikjson.cpp \
+    smoozikxmltree.cpp \
+    smoozikxmlpool.cpp \
+    smooziktrackdata.cpp \
     smooziktrack.cpp \
-    smoozikplaylist.cpp
+    smoozikplaylist.cpp \
+    smoozikplaylistdelta.cpp \
+    smoozikplaylistsnapshot.cpp \
+    smooziktrackcatalog.cpp \
+    smoozikplaylistview.cpp \
+    smooziktracktable.cpp \
+    smoozikrandom.cpp \
+    smoozikreply.cpp \
+    smoozikrequestencoder.cpp
 
 #Code coverage. gcov is required. Comment this if you do not want to use gcov code coverage
 linux-g++:CONFIG(debug, debug|release) {
@@ -0,0 +1,139 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simplehttpserver.h"
+
+#include <QStringList>
+
+SimpleHttpServer::SimpleHttpServer(quint16 port, QObject* parent) :
+    QTcpServer(parent)
+{
+    _requestCount = 0;
+    _lastRequestSize = 0;
+    listen(QHostAddress("127.0.0.1"), port);
+}
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+void SimpleHttpServer::incomingConnection(int socket)
+#else
+void SimpleHttpServer::incomingConnection(qintptr socket)
+#endif
+{
+    // When a new client connects, the server constructs a QTcpSocket and all
+    // communication with the client is done over this QTcpSocket. QTcpSocket
+    // works asynchronously, this means that all the communication is done
+    // in the two slots readClient() and discardClient().
+    QTcpSocket* s = new QTcpSocket(this);
+    connect(s, SIGNAL(readyRead()), this, SLOT(readClient()));
+    connect(s, SIGNAL(disconnected()), this, SLOT(discardClient()));
+    s->setSocketDescriptor(socket);
+}
+
+void SimpleHttpServer::readClient()
+{
+    // This slot is called when the client sent data to the server. The
+    // server waits for the whole request (headers and body) and sends a
+    // very simple document back.
+    QTcpSocket* socket = (QTcpSocket*) sender();
+    QByteArray &buffer = _buffers[socket];
+    buffer += socket->readAll();
+
+    int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return;
+    }
+
+    QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    QStringList tokens = QString(lines.value(0)).split(QRegExp("[ \r\n][ \r\n]*"));
+    if (tokens[0] != "GET" && tokens[0] != "POST") {
+        return;
+    }
+
+    int contentLength = 0;
+    QByteArray ifNoneMatch;
+    bool deflatedRequest = false;
+    bool deflateAccepted = false;
+    for (int i = 1; i < lines.size(); i++) {
+        QByteArray line = lines.at(i).trimmed();
+        int colon = line.indexOf(':');
+        QByteArray name = line.left(colon).trimmed().toLower();
+        if (colon > 0 && name == "content-length") {
+            contentLength = line.mid(colon + 1).trimmed().toInt();
+        } else if (colon > 0 && name == "if-none-match") {
+            ifNoneMatch = line.mid(colon + 1).trimmed();
+        } else if (colon > 0 && name == "content-encoding") {
+            deflatedRequest = line.mid(colon + 1).trimmed().toLower() == "deflate";
+        } else if (colon > 0 && name == "accept-encoding") {
+            deflateAccepted = line.mid(colon + 1).toLower().contains("deflate");
+        }
+    }
+    if (buffer.size() < headerEnd + 4 + contentLength) {
+        return;
+    }
+
+    QByteArray body = buffer.mid(headerEnd + 4, contentLength);
+    _lastRequestSize = body.size();
+    if (deflatedRequest) {
+        // qUncompress expects the uncompressed size first, it is only a hint
+        body.prepend(QByteArray("\0\0\x10\0", 4));
+        body = qUncompress(body);
+    }
+    _lastRequestBody = body;
+
+    _buffers.remove(socket);
+    _requestCount++;
+
+    QTextStream os(socket);
+    os.setAutoDetectUnicode(true);
+    if (!eTag().isEmpty() && ifNoneMatch == eTag()) {
+        os << "HTTP/1.0 304 Not Modified\r\n"
+           "ETag: " << eTag() << "\r\n"
+           "Connection: close\r\n"
+           "\r\n";
+    } else {
+        QByteArray content = response().toUtf8() + "\n";
+        os << "HTTP/1.0 200 Ok\r\n"
+           "Content-Type: text/html; charset=\"utf-8\"\r\n";
+        if (!eTag().isEmpty()) {
+            os << "ETag: " << eTag() << "\r\n";
+        }
+        if (deflateAccepted) {
+            os << "Content-Encoding: deflate\r\n";
+            content = qCompress(content).mid(4);
+        }
+        os << "Connection: close\r\n"
+           "\r\n";
+        os.flush();
+        socket->write(content);
+    }
+    os.flush();
+    socket->close();
+
+    if (socket->state() == QTcpSocket::UnconnectedState) {
+        delete socket;
+    }
+}
+
+void SimpleHttpServer::discardClient()
+{
+    QTcpSocket* socket = (QTcpSocket*) sender();
+    _buffers.remove(socket);
+    socket->deleteLater();
+}
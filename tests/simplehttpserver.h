@@ -0,0 +1,123 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIMPLEHTTPSERVER_H
+#define SIMPLEHTTPSERVER_H
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+
+/**
+ * @brief The SimpleHttpServer class is a simple server used for tests of Smoozik lib.
+ *
+ * It only replies #response to any GET or POST request, once the request has been completely received.
+ * Request bodies sent with "Content-Encoding: deflate" are decompressed, and #response is compressed if the request accepts deflate encoding.
+ * It is inspired by Qt Simple Http Server example
+ */
+class SimpleHttpServer : public QTcpServer
+{
+    Q_OBJECT
+    /**
+     * @brief This property holds the response the server will send to any request it receives.
+     * @af response(), setResponse()
+     * @pm _response
+     */
+    Q_PROPERTY(QString response READ response WRITE setResponse)
+    /**
+     * @brief This property holds the entity tag of #response.
+     *
+     * If not empty, it is sent in the ETag header and requests with a matching If-None-Match header are answered "304 Not Modified".
+     * @af eTag(), setETag()
+     * @pm _eTag
+     */
+    Q_PROPERTY(QByteArray eTag READ eTag WRITE setETag)
+    /**
+     * @brief This property holds the number of requests the server has replied to.
+     * @af requestCount()
+     * @pm _requestCount
+     */
+    Q_PROPERTY(int requestCount READ requestCount)
+    /**
+     * @brief This property holds the body of the last request received, decompressed if it was sent with "Content-Encoding: deflate".
+     * @af lastRequestBody()
+     * @pm _lastRequestBody
+     */
+    Q_PROPERTY(QByteArray lastRequestBody READ lastRequestBody)
+    /**
+     * @brief This property holds the size in bytes of the body of the last request received, as sent on the network.
+     * @af lastRequestSize()
+     * @pm _lastRequestSize
+     */
+    Q_PROPERTY(int lastRequestSize READ lastRequestSize)
+public:
+    explicit SimpleHttpServer(quint16 port, QObject* parent = 0);
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    void incomingConnection(int socket);
+#else
+    void incomingConnection(qintptr socket);
+#endif
+
+    inline QString response() const {
+        return _response;
+    } /**< @see #response */
+
+    inline void setResponse(const QString &response) {
+        _response = response;
+    } /**< @see #response */
+
+    inline QByteArray eTag() const {
+        return _eTag;
+    } /**< @see #eTag */
+
+    inline void setETag(const QByteArray &eTag) {
+        _eTag = eTag;
+    } /**< @see #eTag */
+
+    inline int requestCount() const {
+        return _requestCount;
+    } /**< @see #requestCount */
+
+    inline QByteArray lastRequestBody() const {
+        return _lastRequestBody;
+    } /**< @see #lastRequestBody */
+
+    inline int lastRequestSize() const {
+        return _lastRequestSize;
+    } /**< @see #lastRequestSize */
+
+private:
+    QString _response; /**< @see #response */
+    QByteArray _eTag; /**< @see #eTag */
+    int _requestCount; /**< @see #requestCount */
+    QByteArray _lastRequestBody; /**< @see #lastRequestBody */
+    int _lastRequestSize; /**< @see #lastRequestSize */
+    /**
+     * @brief Data received so far from each client.
+     */
+    QHash<QTcpSocket *, QByteArray> _buffers;
+
+private slots:
+    void readClient();
+    void discardClient();
+};
+
+#endif // SIMPLEHTTPSERVER_H
@@ -0,0 +1,9 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmoozikjson.h \
+    ../simplehttpserver.h
+
+SOURCES += \
+    testsmoozikjson.cpp \
+    ../simplehttpserver.cpp
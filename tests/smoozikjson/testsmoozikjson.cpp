@@ -0,0 +1,345 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmoozikjson.h"
+#include "smoozikjson.h"
+#include "smoozikxml.h"
+#include "smoozikplaylist.h"
+#include "simplehttpserver.h"
+
+#include <new>
+#include <stdlib.h>
+
+#if __cplusplus < 201103L
+#define THROW_BAD_ALLOC throw(std::bad_alloc)
+#define NO_THROW throw()
+#else
+#define THROW_BAD_ALLOC
+#define NO_THROW noexcept
+#endif
+
+/**
+ * @brief True while TestSmoozikJson::allocations() counts heap allocations.
+ */
+static bool allocationCounting = false;
+/**
+ * @brief Number of heap allocations made since counting started.
+ */
+static int allocationCount = 0;
+
+// Global allocation functions are replaced to count heap allocations made while parsing
+void *operator new(size_t size) THROW_BAD_ALLOC
+{
+    if (allocationCounting) {
+        allocationCount++;
+    }
+    void *p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size) THROW_BAD_ALLOC
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) NO_THROW
+{
+    free(p);
+}
+
+void operator delete[](void *p) NO_THROW
+{
+    free(p);
+}
+
+void TestSmoozikJson::parse_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<QByteArray>("xml");
+
+    QTest::newRow("Object") << QByteArray("{\"smoozik\":{\"status\":\"ok\",\"data\":{\"party\":{\"id\":1,\"name\":\"My party\",\"open\":true}}}}")
+                            << QByteArray("<smoozik><status>ok</status><data><party><id>1</id><name>My party</name><open>1</open></party></data></smoozik>");
+    QTest::newRow("Unwrapped root") << QByteArray(" {\"status\":\"ok\",\"data\":{\"sessionKey\":\"abc\",\"place\":{\"id\":\"12\"}}}")
+                                    << QByteArray("<smoozik><status>ok</status><data><sessionKey>abc</sessionKey><place><id>12</id></place></data></smoozik>");
+    QTest::newRow("Array") << QByteArray("{\"smoozik\":{\"status\":\"ok\",\"data\":{\"tracks\":[{\"localId\":\"1\",\"name\":\"track1\",\"duration\":220},{\"localId\":2,\"name\":\"track2\"}]}}}")
+                           << QByteArray("<smoozik><status>ok</status><data><tracks><track><localId>1</localId><name>track1</name><duration>220</duration></track><track><localId>2</localId><name>track2</name></track></tracks></data></smoozik>");
+    QTest::newRow("Wrapped array items") << QByteArray("{\"smoozik\":{\"status\":\"ok\",\"data\":{\"tracks\":[{\"track\":{\"localId\":\"1\"}}]}}}")
+                                         << QByteArray("<smoozik><status>ok</status><data><tracks><track><localId>1</localId></track></tracks></data></smoozik>");
+    QTest::newRow("Numbers") << QByteArray("{\"status\":\"ok\",\"data\":{\"a\":1.5,\"b\":-3,\"c\":12345678901}}")
+                             << QByteArray("<smoozik><status>ok</status><data><a>1.5</a><b>-3</b><c>12345678901</c></data></smoozik>");
+}
+
+void TestSmoozikJson::parse()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(QByteArray, xml);
+
+    SmoozikJson smoozikJson;
+    bool success = smoozikJson.parse(json);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    SmoozikXml smoozikXml;
+    smoozikXml.addData(xml);
+    QCOMPARE(smoozikXml.finish(), true);
+
+    QCOMPARE(success, true);
+    QCOMPARE(smoozikJson.error(), SmoozikManager::NoError);
+    QCOMPARE(smoozikJson.errorMsg(), QString());
+    QCOMPARE(smoozikJson.print(), smoozikXml.print());
+    QCOMPARE(smoozikJson.parsedString(), smoozikXml.parsedString());
+    QCOMPARE(smoozikJson["party"], smoozikXml["party"]);
+    QCOMPARE(smoozikJson["tracks"], smoozikXml["tracks"]);
+    QCOMPARE(smoozikJson[0], smoozikXml[0]);
+    QCOMPARE(smoozikJson.value("party/name"), smoozikXml.value("party/name"));
+    QCOMPARE(smoozikJson.value("tracks/1/track/localId"), smoozikXml.value("tracks/1/track/localId"));
+#else
+    Q_UNUSED(xml);
+    QCOMPARE(success, false);
+    QCOMPARE(smoozikJson.error(), SmoozikManager::ParseError);
+#endif
+}
+
+void TestSmoozikJson::errors_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<int>("error");
+    QTest::addColumn<QString>("errorMsg");
+
+    QTest::newRow("Empty") << QByteArray() << (int) SmoozikManager::ServerUnreachable << "Could not reach server.";
+    QTest::newRow("Invalid") << QByteArray("{\"smoozik\":") << (int) SmoozikManager::ParseError << QString();
+    QTest::newRow("No smoozik") << QByteArray("{\"data\":{}}") << (int) SmoozikManager::ParseError << "Could not parse json : smoozik element is missing.";
+    QTest::newRow("No status") << QByteArray("{\"smoozik\":{\"data\":{}}}") << (int) SmoozikManager::ParseError << "Could not parse json : status element is missing.";
+    QTest::newRow("No error") << QByteArray("{\"smoozik\":{\"status\":\"failed\"}}") << (int) SmoozikManager::ParseError << "Could not parse json : failed element is missing.";
+    QTest::newRow("No code") << QByteArray("{\"smoozik\":{\"status\":\"failed\",\"error\":{}}}") << (int) SmoozikManager::ParseError << "Could not parse json : code element is missing.";
+    QTest::newRow("No data") << QByteArray("{\"smoozik\":{\"status\":\"ok\"}}") << (int) SmoozikManager::ParseError << "Could not parse json : data element is missing.";
+    QTest::newRow("Failed") << QByteArray("{\"smoozik\":{\"status\":\"failed\",\"error\":{\"code\":3,\"message\":\"Authentication Failed\"}}}") << (int) SmoozikManager::AuthenticationFailed << "Authentication Failed";
+}
+
+void TestSmoozikJson::errors()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(int, error);
+    QFETCH(QString, errorMsg);
+
+    SmoozikJson smoozikJson;
+    QCOMPARE(smoozikJson.parse(json), false);
+    QCOMPARE(smoozikJson.parsedString(), QString());
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    QCOMPARE((int) smoozikJson.error(), error);
+    if (!errorMsg.isNull()) {
+        QCOMPARE(smoozikJson.errorMsg(), errorMsg);
+    }
+
+    QVERIFY(smoozikJson.parseTracks(json) == 0);
+    QCOMPARE((int) smoozikJson.error(), error);
+#else
+    Q_UNUSED(error);
+    Q_UNUSED(errorMsg);
+    QCOMPARE(smoozikJson.error(), SmoozikManager::ParseError);
+#endif
+}
+
+void TestSmoozikJson::parseTracks()
+{
+    QByteArray json("{\"smoozik\":{\"status\":\"ok\",\"data\":{\"tracks\":["
+                    "{\"localId\":\"1\",\"name\":\"track1\",\"artist\":\"artist1\",\"album\":\"album1\",\"duration\":220},"
+                    "{\"track\":{\"localId\":2,\"name\":\"track2\"}},"
+                    "{\"localId\":\"1\",\"name\":\"duplicate\"},"
+                    "{\"localId\":\"3\",\"name\":\"track3\",\"fileName\":\"track3.mp3\",\"duration\":\"12\"}"
+                    "]}}}");
+    QByteArray xml("<smoozik><status>ok</status><data><tracks>"
+                   "<track><localId>1</localId><name>track1</name><artist>artist1</artist><album>album1</album><duration>220</duration></track>"
+                   "<track><localId>2</localId><name>track2</name></track>"
+                   "<track><localId>1</localId><name>duplicate</name></track>"
+                   "<track><localId>3</localId><name>track3</name><fileName>track3.mp3</fileName><duration>12</duration></track>"
+                   "</tracks></data></smoozik>");
+
+    SmoozikJson smoozikJson;
+    SmoozikPlaylist *playlist = smoozikJson.parseTracks(json, this);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    SmoozikXml smoozikXml;
+    SmoozikPlaylist *expected = smoozikXml.parseTracks(xml, this);
+    QVERIFY(expected != 0);
+
+    QVERIFY(playlist != 0);
+    QCOMPARE(playlist->parent(), (QObject *)this);
+    QCOMPARE(playlist->count(), 3);
+    QCOMPARE(playlist->count(), expected->count());
+    for (int i = 0; i < expected->count(); i++) {
+        QCOMPARE(playlist->value(i)->localId(), expected->value(i)->localId());
+        QCOMPARE(playlist->value(i)->name(), expected->value(i)->name());
+        QCOMPARE(playlist->value(i)->artist(), expected->value(i)->artist());
+        QCOMPARE(playlist->value(i)->album(), expected->value(i)->album());
+        QCOMPARE(playlist->value(i)->duration(), expected->value(i)->duration());
+        QCOMPARE(playlist->value(i)->fileName(), expected->value(i)->fileName());
+    }
+
+    // Same tracks through the variant tree
+    QCOMPARE(smoozikJson.parse(json), true);
+    SmoozikPlaylist variantPlaylist(smoozikJson["tracks"].toList());
+    QCOMPARE(variantPlaylist.count(), playlist->count());
+    QCOMPARE(variantPlaylist.last()->fileName(), playlist->last()->fileName());
+    delete expected;
+    delete playlist;
+
+    // Fractional durations are read as numbers
+    playlist = smoozikJson.parseTracks("{\"status\":\"ok\",\"data\":{\"tracks\":["
+                                       "{\"localId\":\"1\",\"duration\":\"215.0\"},"
+                                       "{\"localId\":\"2\",\"duration\":180.4}]}}");
+    QVERIFY(playlist != 0);
+    QCOMPARE(playlist->value(0)->duration(), 215);
+    QCOMPARE(playlist->value(1)->duration(), 180);
+    delete playlist;
+
+    // SmoozikPlaylist::fromReply() detects the format of the response
+    SimpleHttpServer server(8194);
+    server.setResponse(QString::fromUtf8(json));
+    QNetworkAccessManager manager;
+    QNetworkReply *reply = manager.get(QNetworkRequest(QUrl("http://127.0.0.1:8194")));
+    for (int i = 0; i < 100 && !reply->isFinished(); i++) {
+        QTest::qWait(50);
+    }
+    playlist = SmoozikPlaylist::fromReply(reply);
+    QVERIFY(playlist != 0);
+    QCOMPARE(playlist->count(), 3);
+    delete playlist;
+#else
+    Q_UNUSED(xml);
+    QVERIFY(playlist == 0);
+    QCOMPARE(smoozikJson.error(), SmoozikManager::ParseError);
+#endif
+}
+
+void TestSmoozikJson::benchmark_data()
+{
+    QTest::addColumn<bool>("json");
+    QTest::addColumn<bool>("typed");
+
+    QTest::newRow("XML variant") << false << false;
+    QTest::newRow("JSON variant") << true << false;
+    QTest::newRow("XML typed") << false << true;
+    QTest::newRow("JSON typed") << true << true;
+}
+
+void TestSmoozikJson::benchmark()
+{
+    QFETCH(bool, json);
+    QFETCH(bool, typed);
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    if (json) {
+        return;
+    }
+#endif
+
+    QByteArray data = topTracksResponse(json);
+    int count = 0;
+    QBENCHMARK {
+        count = parseTopTracks(data, json, typed);
+    }
+    QCOMPARE(count, MAX_ADVISED_PLAYLIST_SIZE);
+}
+
+void TestSmoozikJson::allocations_data()
+{
+    benchmark_data();
+}
+
+void TestSmoozikJson::allocations()
+{
+    QFETCH(bool, json);
+    QFETCH(bool, typed);
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    if (json) {
+        return;
+    }
+#endif
+
+    QByteArray data = topTracksResponse(json);
+    // First parse fills lazily built caches which are not part of the per-response cost
+    parseTopTracks(data, json, typed);
+
+    allocationCounting = true;
+    allocationCount = 0;
+    int count = parseTopTracks(data, json, typed);
+    allocationCounting = false;
+
+    QCOMPARE(count, MAX_ADVISED_PLAYLIST_SIZE);
+    QVERIFY(allocationCount > 0);
+    QTest::setBenchmarkResult(allocationCount, QTest::Events);
+}
+
+QByteArray TestSmoozikJson::topTracksResponse(bool json)
+{
+    // getTopTracks response with MAX_ADVISED_PLAYLIST_SIZE tracks
+    QByteArray data;
+    if (json) {
+        data = "{\"smoozik\":{\"status\":\"ok\",\"data\":{\"tracks\":[";
+        for (int i = 0; i < MAX_ADVISED_PLAYLIST_SIZE; i++) {
+            data += QString("%1{\"localId\":\"%2\",\"name\":\"Track %2\",\"artist\":\"Artist %3\",\"album\":\"Album %3\",\"duration\":%4}")
+                    .arg(i ? "," : "").arg(i).arg(i / 10).arg(180 + i).toUtf8();
+        }
+        data += "]}}}";
+    } else {
+        data = "<smoozik><status>ok</status><data><tracks>";
+        for (int i = 0; i < MAX_ADVISED_PLAYLIST_SIZE; i++) {
+            data += QString("<track><localId>%1</localId><name>Track %1</name><artist>Artist %2</artist><album>Album %2</album><duration>%3</duration></track>")
+                    .arg(i).arg(i / 10).arg(180 + i).toUtf8();
+        }
+        data += "</tracks></data></smoozik>";
+    }
+    return data;
+}
+
+int TestSmoozikJson::parseTopTracks(const QByteArray &data, bool json, bool typed)
+{
+    SmoozikPlaylist *playlist;
+    if (typed) {
+        if (json) {
+            SmoozikJson smoozikJson;
+            playlist = smoozikJson.parseTracks(data);
+        } else {
+            SmoozikXml smoozikXml;
+            playlist = smoozikXml.parseTracks(data);
+        }
+    } else {
+        if (json) {
+            SmoozikJson smoozikJson;
+            smoozikJson.parse(data);
+            playlist = new SmoozikPlaylist(smoozikJson["tracks"].toList());
+        } else {
+            SmoozikXml smoozikXml;
+            smoozikXml.addData(data);
+            smoozikXml.finish();
+            playlist = new SmoozikPlaylist(smoozikXml["tracks"].toList());
+        }
+    }
+    int count = playlist->count();
+    delete playlist;
+    return count;
+}
+
+QTEST_XML_MAIN(TestSmoozikJson)
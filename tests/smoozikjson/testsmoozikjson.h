@@ -0,0 +1,55 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTSMOOZIKJSON_H
+#define TESTSMOOZIKJSON_H
+
+#include <QtTest>
+#include "config.h"
+
+class TestSmoozikJson : public QObject
+{
+    Q_OBJECT
+private slots:
+    void parse_data();
+    void parse();
+    void errors_data();
+    void errors();
+    void parseTracks();
+    void benchmark_data();
+    void benchmark();
+    void allocations_data();
+    void allocations();
+
+private:
+    /**
+     * @brief Returns a getTopTracks response with MAX_ADVISED_PLAYLIST_SIZE tracks, in JSON if @em json is true and in XML otherwise.
+     */
+    static QByteArray topTracksResponse(bool json);
+
+    /**
+     * @brief Parses getTopTracks response @em data and returns the number of tracks read.
+     * @param json True if @em data is JSON, false if it is XML
+     * @param typed True to read tracks with parseTracks(), false to go through the variant tree
+     */
+    static int parseTopTracks(const QByteArray &data, bool json, bool typed);
+};
+
+#endif // TESTSMOOZIKJSON_H
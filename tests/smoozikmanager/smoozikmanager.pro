@@ -1,7 +1,10 @@
 include(../tests.pri)
 
 HEADERS += \
-    testsmoozikmanager.h
+    testsmoozikmanager.h \
+    ../simplehttpserver.h \
+    ../localsmoozikmanager.h
 
 SOURCES += \
-    testsmoozikmanager.cpp
+    testsmoozikmanager.cpp \
+    ../simplehttpserver.cpp
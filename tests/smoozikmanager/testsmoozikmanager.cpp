@@ -21,6 +21,8 @@
 #include "testsmoozikmanager.h"
 #include "smoozikmanager.h"
 #include "smoozikxml.h"
+#include "simplehttpserver.h"
+#include "localsmoozikmanager.h"
 
 #include <QDomElement>
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
@@ -200,6 +202,104 @@ void TestSmoozikManager::sendPlaylist()
     QCOMPARE(xml.error(), SmoozikManager::NoError);
 }
 
+void TestSmoozikManager::updatePlaylist()
+{
+    SimpleHttpServer server(8195);
+    server.setResponse("<smoozik><status>ok</status><data></data></smoozik>");
+    LocalSmoozikManager manager(8195);
+    QCOMPARE(manager.playlistDeltaThreshold(), -1);
+
+    SmoozikPlaylist previous;
+    for (int i = 0; i < 20; i++) {
+        previous.addTrack(QString::number(i), QString("track%1").arg(i), "artist");
+    }
+    SmoozikPlaylist playlist;
+    playlist.addTracks(previous.tracks());
+    playlist.removeAt(3);
+    playlist.addTrack("20", "track20", "artist");
+    playlist.removeAt(0);
+    playlist.addTrack("0", "renamed", "artist");
+
+    // By default, the whole playlist is sent
+    QNetworkReply *reply = manager.updatePlaylist(&previous, &playlist);
+    QCOMPARE(reply->url().path().endsWith("/sendPlaylist"), true);
+    SmoozikXml xml;
+    QCOMPARE(xml.parse(reply), true);
+    reply = manager.updatePlaylist(&playlist, &playlist);
+    QVERIFY(reply != 0);
+    QCOMPARE(reply->url().path().endsWith("/sendPlaylist"), true);
+    QCOMPARE(xml.parse(reply), true);
+
+    // Small delta is sent alone
+    manager.setPlaylistDeltaThreshold(25);
+    reply = manager.updatePlaylist(&previous, &playlist);
+    QCOMPARE(reply->url().path().endsWith("/updatePlaylist"), true);
+    QString body = QUrl::fromPercentEncoding(server.lastRequestBody());
+    QVERIFY(body.contains("<localId>20</localId>"));
+    QVERIFY(body.contains("<name>renamed</name>"));
+    QVERIFY(body.contains("<localIds>"));
+    QVERIFY(body.contains("<localId>3</localId>"));
+    QVERIFY(!body.contains("<localId>5</localId>"));
+    QCOMPARE(xml.parse(reply), true);
+
+    // Nothing is sent when nothing changed
+    QVERIFY(manager.updatePlaylist(&playlist, &playlist) == 0);
+    QCOMPARE(server.requestCount(), 3);
+
+    // No previous playlist or a large delta fall back to sendPlaylist
+    reply = manager.updatePlaylist(0, &playlist);
+    QCOMPARE(reply->url().path().endsWith("/sendPlaylist"), true);
+    QCOMPARE(xml.parse(reply), true);
+
+    manager.setPlaylistDeltaThreshold(10);
+    reply = manager.updatePlaylist(&previous, &playlist);
+    QCOMPARE(reply->url().path().endsWith("/sendPlaylist"), true);
+    body = QUrl::fromPercentEncoding(server.lastRequestBody());
+    QVERIFY(body.contains("<localId>5</localId>"));
+    QVERIFY(!body.contains("<localIds>"));
+    QCOMPARE(xml.parse(reply), true);
+
+    manager.setPlaylistDeltaThreshold(-1);
+    reply = manager.updatePlaylist(&playlist, &playlist);
+    QCOMPARE(reply->url().path().endsWith("/sendPlaylist"), true);
+    QCOMPARE(xml.parse(reply), true);
+    QCOMPARE(server.requestCount(), 6);
+}
+
+void TestSmoozikManager::sendPlaylistView()
+{
+    SimpleHttpServer server(8196);
+    server.setResponse("<smoozik><status>ok</status><data></data></smoozik>");
+    LocalSmoozikManager manager(8196);
+
+    SmoozikPlaylist library;
+    for (int i = 0; i < 100; i++) {
+        library.addTrack(QString::number(i), QString("track%1").arg(i), "artist", "album", 200 + i);
+    }
+    SmoozikTrackCatalog catalog;
+    QCOMPARE(catalog.load(&library), true);
+
+    SmoozikPlaylistView view(&catalog);
+    SmoozikPlaylist playlist;
+    for (int i = 0; i < 100; i += 7) {
+        view.addTrack(i);
+        playlist.addTrack(library.trackData(i));
+    }
+
+    // A view is sent as the equivalent playlist
+    QNetworkReply *reply = manager.sendPlaylist(&playlist);
+    QCOMPARE(reply->url().path().endsWith("/sendPlaylist"), true);
+    SmoozikXml xml;
+    QCOMPARE(xml.parse(reply), true);
+    QByteArray body = server.lastRequestBody();
+
+    reply = manager.sendPlaylist(&view);
+    QCOMPARE(reply->url().path().endsWith("/sendPlaylist"), true);
+    QCOMPARE(xml.parse(reply), true);
+    QCOMPARE(server.lastRequestBody().contains("track7"), true);
+    QCOMPARE(server.lastRequestBody(), body);
+}
+
 void TestSmoozikManager::setTrack()
 {
     SmoozikManager manager(APIKEY, SECRET, SmoozikManager::XML, true);
@@ -310,4 +410,457 @@ void TestSmoozikManager::forceDisconnectUsers()
     QCOMPARE(xml["disconnectedUserCount"].toString(), QString::number(1));
 }
 
+void TestSmoozikManager::requestsPerHost()
+{
+    SimpleHttpServer server(8184);
+    server.setResponse("<smoozik><status>ok</status><data></data></smoozik>");
+    LocalSmoozikManager manager(8184, false);
+    manager.setMaxRequestsPerHost(2);
+    manager.setDeduplicateReads(false);
+
+    QList<SmoozikReply *> replies;
+    for (int i = 0; i < 5; i++) {
+        replies << manager.send("getTopTracks");
+    }
+    QCOMPARE(manager.inFlightRequestCount(), 2);
+    QCOMPARE(manager.queuedRequestCount(), 3);
+
+    // Aborted queued requests are never sent
+    replies.takeLast()->abort();
+
+    foreach(SmoozikReply *reply, replies) {
+        QCOMPARE(reply->waitForFinished(5000), true);
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+    }
+    QCOMPARE(manager.inFlightRequestCount(), 0);
+    QCOMPARE(manager.queuedRequestCount(), 0);
+    QCOMPARE(server.requestCount(), 4);
+
+    // Test server closes connections after each reply
+    QCOMPARE(manager.estimatedConnectionOpenCount(), 4);
+    QCOMPARE(manager.estimatedConnectionReuseCount(), 0);
+    manager.resetConnectionStatistics();
+    QCOMPARE(manager.estimatedConnectionOpenCount(), 0);
+
+    // Raising the limit sends queued requests at once
+    manager.setMaxRequestsPerHost(1);
+    SmoozikReply *reply1 = manager.send("getTopTracks");
+    SmoozikReply *reply2 = manager.send("getTopTracks");
+    QCOMPARE(manager.queuedRequestCount(), 1);
+    manager.setMaxRequestsPerHost(0);
+    QCOMPARE(manager.queuedRequestCount(), 0);
+    QCOMPARE(manager.inFlightRequestCount(), 2);
+    QCOMPARE(reply1->waitForFinished(5000), true);
+    QCOMPARE(reply2->waitForFinished(5000), true);
+}
+
+void TestSmoozikManager::batch()
+{
+    SimpleHttpServer server(8185);
+    server.setResponse("<smoozik><status>ok</status><data></data></smoozik>");
+    LocalSmoozikManager manager(8185, false);
+    manager.setBatchInterval(60000);
+    manager.setBatchSize(3);
+
+    // Requests are held until the batch is full
+    SmoozikReply *set0 = manager.send("setTrack");
+    SmoozikReply *set1 = manager.send("setTrack");
+    QCOMPARE(manager.inFlightRequestCount(), 0);
+    SmoozikReply *top = manager.send("getTopTracks");
+
+    // Read-only request waits for previous writes of the batch
+    QCOMPARE(manager.inFlightRequestCount(), 2);
+    QCOMPARE(set0->request().attribute(QNetworkRequest::HttpPipeliningAllowedAttribute).toBool(), true);
+    QCOMPARE(top->waitForFinished(5000), true);
+    QCOMPARE(set0->isFinished(), true);
+    QCOMPARE(set1->isFinished(), true);
+    QCOMPARE(top->error(), QNetworkReply::NoError);
+    QCOMPARE(server.requestCount(), 3);
+
+    // Batch window sends incomplete batches
+    manager.setBatchInterval(10);
+    SmoozikReply *reply = manager.send("unsetTrack");
+    QCOMPARE(manager.inFlightRequestCount(), 0);
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+
+    // Aborted requests are never sent and do not block the batch
+    manager.setBatchInterval(60000);
+    SmoozikReply *aborted = manager.send("setTrack");
+    reply = manager.send("getTopTracks");
+    aborted->abort();
+    manager.flushBatch();
+    QCOMPARE(manager.inFlightRequestCount(), 1);
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(server.requestCount(), 5);
+
+    // Requests deleted while their stage is in flight do not block later stages
+    SmoozikReply *deleted = manager.send("setTrack");
+    reply = manager.send("getTopTracks");
+    manager.flushBatch();
+    QCOMPARE(deleted->isFinished(), false);
+    QCOMPARE(reply->isFinished(), false);
+    delete deleted;
+    QCOMPARE(manager.inFlightRequestCount(), 1);
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+
+    // Disabling batching sends the current batch
+    reply = manager.send("getTopTracks");
+    manager.setBatchInterval(0);
+    QCOMPARE(manager.inFlightRequestCount(), 1);
+    QCOMPARE(reply->waitForFinished(5000), true);
+}
+
+void TestSmoozikManager::endpoints()
+{
+    SmoozikManager manager(APIKEY, SmoozikManager::XML, false);
+    QCOMPARE(manager.baseUrl(), QUrl("http://www.smoozik.com/index.php/api/"));
+    QCOMPARE(manager.endpoint("login"), QUrl("http://www.smoozik.com/index.php/api/login"));
+
+    manager.setSecure(true);
+    QCOMPARE(manager.endpoint("login"), QUrl("https://www.smoozik.com/index.php/api/login"));
+    manager.setSecure(false);
+
+    // Missing trailing slash is added
+    manager.setBaseUrl(QUrl("http://127.0.0.1:8186/api"));
+    QCOMPARE(manager.baseUrl(), QUrl("http://127.0.0.1:8186/api/"));
+    QCOMPARE(manager.endpoint("login"), QUrl("http://127.0.0.1:8186/api/login"));
+
+    // Overrides survive base url changes
+    manager.setEndpoint("getTopTracks", QUrl("http://127.0.0.1:8187/top"));
+    manager.setBaseUrl(QUrl("http://127.0.0.1:8186/v2/"));
+    QCOMPARE(manager.endpoint("getTopTracks"), QUrl("http://127.0.0.1:8187/top"));
+    QCOMPARE(manager.endpoint("login"), QUrl("http://127.0.0.1:8186/v2/login"));
+    manager.setEndpoint("getTopTracks", QUrl());
+    QCOMPARE(manager.endpoint("getTopTracks"), QUrl("http://127.0.0.1:8186/v2/getTopTracks"));
+
+    // Requests are sent to endpoints
+    SimpleHttpServer server(8186);
+    server.setResponse("<smoozik><status>ok</status><data></data></smoozik>");
+    SmoozikReply *reply = manager.send("getTopTracks");
+    QCOMPARE(reply->request().url().host(), QString("127.0.0.1"));
+    QCOMPARE(reply->request().url().path(), QString("/v2/getTopTracks"));
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(server.requestCount(), 1);
+}
+
+void TestSmoozikManager::retry()
+{
+    // Nothing listens on port 8188
+    LocalSmoozikManager manager(8188, false);
+    manager.setCircuitBreakerThreshold(0);
+    manager.setRetryDelay(20);
+    manager.setMaxRetries(2);
+    QCOMPARE(manager.isIdempotent("getTopTracks"), true);
+    QCOMPARE(manager.isIdempotent("startParty"), false);
+    QCOMPARE(manager.isIdempotent("unknownMethod"), false);
+    QCOMPARE(manager.maxRetries("getTopTracks"), 2);
+    QCOMPARE(manager.maxRetries("startParty"), 0);
+
+    SmoozikReply *reply = manager.send("getTopTracks");
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->error(), QNetworkReply::ConnectionRefusedError);
+    QCOMPARE(reply->retryCount(), 2);
+
+    // Non-idempotent methods are never retried
+    reply = manager.send("startParty");
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->error(), QNetworkReply::ConnectionRefusedError);
+    QCOMPARE(reply->retryCount(), 0);
+
+    // Per-method setting overrides the default
+    manager.setMaxRetries("getTopTracks", 1);
+    reply = manager.send("getTopTracks");
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->retryCount(), 1);
+    manager.setMaxRetries("getTopTracks", -1);
+    QCOMPARE(manager.maxRetries("getTopTracks"), 2);
+
+    // Requests aborted while waiting for a retry finish at once
+    manager.setRetryDelay(60000);
+    reply = manager.send("getTopTracks");
+    for (int i = 0; i < 100 && reply->retryCount() == 0; i++) {
+        QTest::qWait(50);
+    }
+    QCOMPARE(reply->retryCount(), 1);
+    reply->abort();
+    QCOMPARE(reply->isFinished(), true);
+    QCOMPARE(reply->error(), QNetworkReply::OperationCanceledError);
+}
+
+void TestSmoozikManager::circuitBreaker()
+{
+    LocalSmoozikManager manager(8189, false);
+    manager.setMaxRetries(0);
+    manager.setCircuitBreakerThreshold(2);
+    manager.setCircuitBreakerTimeout(500);
+
+    for (int i = 0; i < 2; i++) {
+        SmoozikReply *reply = manager.send("getTopTracks");
+        QCOMPARE(reply->waitForFinished(5000), true);
+        QCOMPARE(reply->error(), QNetworkReply::ConnectionRefusedError);
+    }
+    QCOMPARE(manager.isCircuitOpen("getTopTracks"), true);
+
+    // Requests fail fast, but still finish after being returned
+    SmoozikReply *reply = manager.send("getTopTracks");
+    QSignalSpy finishedSpy(reply, SIGNAL(finished()));
+    QCOMPARE(reply->isFinished(), false);
+    QCOMPARE(reply->waitForFinished(100), true);
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(reply->error(), QNetworkReply::TemporaryNetworkFailureError);
+
+    // Once the timeout is over, a probe closes the circuit
+    SimpleHttpServer server(8189);
+    server.setResponse("<smoozik><status>ok</status><data></data></smoozik>");
+    QTest::qWait(600);
+    QCOMPARE(manager.isCircuitOpen("getTopTracks"), false);
+    reply = manager.send("getTopTracks");
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(server.requestCount(), 1);
+
+    // Requests aborted by the caller are not failures
+    QTcpServer silentServer;
+    QVERIFY(silentServer.listen(QHostAddress::LocalHost, 8197));
+    LocalSmoozikManager silentManager(8197, false);
+    silentManager.setMaxRetries(0);
+    silentManager.setCircuitBreakerThreshold(2);
+    for (int i = 0; i < 2; i++) {
+        reply = silentManager.send("getTopTracks");
+        QCOMPARE(reply->waitForFinished(100), false);
+        reply->abort();
+        QCOMPARE(reply->error(), QNetworkReply::OperationCanceledError);
+    }
+    QCOMPARE(silentManager.isCircuitOpen("getTopTracks"), false);
+
+    // Requests which reach the timeout are
+    silentManager.setBlocking(true);
+    silentManager.setTimeout(100);
+    for (int i = 0; i < 2; i++) {
+        QNetworkReply *blockingReply = silentManager.request("getTopTracks");
+        QCOMPARE(blockingReply->error(), QNetworkReply::OperationCanceledError);
+    }
+    QCOMPARE(silentManager.isCircuitOpen("getTopTracks"), true);
+}
+
+void TestSmoozikManager::deduplicateReads()
+{
+    SimpleHttpServer server(8190);
+    server.setResponse("<smoozik><status>ok</status><data><tracks></tracks></data></smoozik>");
+    LocalSmoozikManager manager(8190, false);
+    QMap<QString, QString> params;
+    params.insert("count", "3");
+
+    // Identical read-only requests share a server request
+    SmoozikReply *leader = manager.send("getTopTracks");
+    SmoozikReply *follower = manager.send("getTopTracks");
+    SmoozikReply *other = manager.send("getTopTracks", params);
+    SmoozikReply *write = manager.send("unsetAllTracks");
+    SmoozikReply *writeAgain = manager.send("unsetAllTracks");
+    QCOMPARE(manager.inFlightRequestCount(), 4);
+    QCOMPARE(manager.deduplicatedRequestCount(), 1);
+    QSignalSpy finishedSpy(follower, SIGNAL(finished()));
+
+    QCOMPARE(follower->waitForFinished(5000), true);
+    QCOMPARE(leader->isFinished(), true);
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(follower->error(), QNetworkReply::NoError);
+    QCOMPARE(follower->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(follower->readAll(), leader->readAll());
+    QCOMPARE(other->waitForFinished(5000), true);
+    QCOMPARE(write->waitForFinished(5000), true);
+    QCOMPARE(writeAgain->waitForFinished(5000), true);
+    QCOMPARE(server.requestCount(), 4);
+
+    // Finished requests are not shared
+    follower = manager.send("getTopTracks");
+    QCOMPARE(manager.inFlightRequestCount(), 1);
+    QCOMPARE(follower->waitForFinished(5000), true);
+
+    // A follower is sent when the leader is aborted or deleted
+    leader = manager.send("getTopTracks");
+    follower = manager.send("getTopTracks");
+    SmoozikReply *lastFollower = manager.send("getTopTracks");
+    QCOMPARE(manager.inFlightRequestCount(), 1);
+    leader->abort();
+    QCOMPARE(manager.inFlightRequestCount(), 1);
+    delete follower;
+    QCOMPARE(manager.inFlightRequestCount(), 1);
+    QCOMPARE(lastFollower->waitForFinished(5000), true);
+    QCOMPARE(lastFollower->error(), QNetworkReply::NoError);
+    QCOMPARE(server.requestCount(), 6);
+
+    // Deduplication can be disabled
+    manager.resetConnectionStatistics();
+    manager.setDeduplicateReads(false);
+    leader = manager.send("getTopTracks");
+    follower = manager.send("getTopTracks");
+    QCOMPARE(manager.inFlightRequestCount(), 2);
+    QCOMPARE(manager.deduplicatedRequestCount(), 0);
+    QCOMPARE(follower->waitForFinished(5000), true);
+    QCOMPARE(leader->waitForFinished(5000), true);
+}
+
+void TestSmoozikManager::cache()
+{
+    SimpleHttpServer server(8191);
+    server.setResponse("<smoozik><status>ok</status><data><tracks>1</tracks></data></smoozik>");
+    server.setETag("\"1\"");
+    LocalSmoozikManager manager(8191, false);
+    manager.setCacheTtl(300);
+    QCOMPARE(manager.cacheTtl("getTopTracks"), 300);
+    QCOMPARE(manager.cacheTtl("setTrack"), 0);
+
+    SmoozikReply *reply = manager.send("getTopTracks");
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QByteArray content = reply->readAll();
+    QCOMPARE(server.requestCount(), 1);
+
+    // Fresh responses are served from cache, but still finish asynchronously
+    reply = manager.send("getTopTracks");
+    QCOMPARE(reply->isFinished(), false);
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->readAll(), content);
+    QCOMPARE(server.requestCount(), 1);
+    QCOMPARE(manager.cacheHitCount(), 1);
+
+    // Expired responses are revalidated
+    QTest::qWait(400);
+    reply = manager.send("getTopTracks");
+    QCOMPARE(reply->request().rawHeader("If-None-Match"), QByteArray("\"1\""));
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(reply->readAll(), content);
+    QCOMPARE(server.requestCount(), 2);
+    QCOMPARE(manager.notModifiedCount(), 1);
+
+    // Writes empty the cache
+    server.setResponse("<smoozik><status>ok</status><data><tracks>2</tracks></data></smoozik>");
+    server.setETag("\"2\"");
+    reply = manager.send("setTrack");
+    QCOMPARE(reply->waitForFinished(5000), true);
+    reply = manager.send("getTopTracks");
+    QCOMPARE(reply->waitForFinished(5000), true);
+    content = reply->readAll();
+    QVERIFY(content.contains("<tracks>2</tracks>"));
+    QCOMPARE(server.requestCount(), 4);
+
+    // Cache can be emptied explicitly
+    server.setResponse("<smoozik><status>ok</status><data><tracks>3</tracks></data></smoozik>");
+    server.setETag("\"3\"");
+    manager.invalidateCache("getTopTracks");
+    reply = manager.send("getTopTracks");
+    QCOMPARE(reply->waitForFinished(5000), true);
+    content = reply->readAll();
+    QVERIFY(content.contains("<tracks>3</tracks>"));
+    QCOMPARE(server.requestCount(), 5);
+
+    // Stale responses are served while revalidated in the background
+    manager.setStaleWhileRevalidate(60000);
+    server.setResponse("<smoozik><status>ok</status><data><tracks>4</tracks></data></smoozik>");
+    server.setETag("\"4\"");
+    QTest::qWait(400);
+    reply = manager.send("getTopTracks");
+    QCOMPARE(manager.inFlightRequestCount(), 1);
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->readAll(), content);
+    for (int i = 0; i < 100 && manager.inFlightRequestCount() > 0; i++) {
+        QTest::qWait(50);
+    }
+    QCOMPARE(server.requestCount(), 6);
+    reply = manager.send("getTopTracks");
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QVERIFY(reply->readAll().contains("<tracks>4</tracks>"));
+    QCOMPARE(server.requestCount(), 6);
+}
+
+void TestSmoozikManager::compression()
+{
+    QString response("<smoozik><status>ok</status><data></data></smoozik>");
+    SimpleHttpServer server(8192);
+    server.setResponse(response);
+    LocalSmoozikManager manager(8192, false);
+
+    QString data("<playlist>");
+    for (int i = 0; i < 200; i++) {
+        data += QString("<track><localId>%1</localId><name>Track %1</name><artist>Artist</artist><album>Album</album></track>").arg(i);
+    }
+    data += "</playlist>";
+    QMap<QString, QString> postParams;
+    postParams.insert("data", data);
+
+    // Uncompressed request
+    SmoozikReply *reply = manager.send("sendPlaylist", QMap<QString, QString>(), postParams);
+    QCOMPARE(reply->request().hasRawHeader("Content-Encoding"), false);
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QByteArray body = server.lastRequestBody();
+    int size = server.lastRequestSize();
+    QCOMPARE(size, body.size());
+
+    // Compressed request decompresses to the same body
+    manager.setCompressionThreshold(256);
+    reply = manager.send("sendPlaylist", QMap<QString, QString>(), postParams);
+    QCOMPARE(reply->request().rawHeader("Content-Encoding"), QByteArray("deflate"));
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(server.lastRequestBody(), body);
+    QVERIFY(server.lastRequestSize() < size / 4);
+
+    // Small requests are not compressed
+    reply = manager.send("startParty");
+    QCOMPARE(reply->request().hasRawHeader("Content-Encoding"), false);
+    QCOMPARE(reply->waitForFinished(5000), true);
+
+    // Without explicit negotiation, Qt decompresses responses itself, even though the server answers with "Content-Encoding: deflate"
+    QCOMPARE(manager.acceptCompressedResponses(), false);
+    QCOMPARE(reply->request().hasRawHeader("Accept-Encoding"), false);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->rawHeader("Content-Encoding"), QByteArray("deflate"));
+    QCOMPARE(reply->readAll(), response.toUtf8() + "\n");
+
+    // Compressed responses are decompressed, and headers describing the encoded body are dropped
+    manager.setAcceptCompressedResponses(true);
+    reply = manager.send("startParty");
+    QCOMPARE(reply->request().rawHeader("Accept-Encoding"), QByteArray("deflate"));
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->hasRawHeader("Content-Encoding"), false);
+    QCOMPARE(reply->hasRawHeader("Content-Length"), false);
+    QCOMPARE(reply->readAll(), response.toUtf8() + "\n");
+}
+
+void TestSmoozikManager::deleteWithPendingRequests()
+{
+    // Server accepts connections but never answers
+    QTcpServer silentServer;
+    QVERIFY(silentServer.listen(QHostAddress::LocalHost, 8198));
+    LocalSmoozikManager *manager = new LocalSmoozikManager(8198, false);
+    manager->setMaxRequestsPerHost(1);
+
+    // One request in flight, one queued, one waiting in a batch
+    QPointer<SmoozikReply> inFlight = manager->send("getTopTracks");
+    QPointer<SmoozikReply> queued = manager->send("startParty");
+    manager->setBatchInterval(60000);
+    QPointer<SmoozikReply> batched = manager->send("joinParty");
+    QTest::qWait(100);
+    QCOMPARE(inFlight->isFinished(), false);
+    QCOMPARE(manager->inFlightRequestCount(), 1);
+
+    delete manager;
+    QVERIFY(inFlight.isNull());
+    QVERIFY(queued.isNull());
+    QVERIFY(batched.isNull());
+
+    // A reply deleted by the caller aborts its network reply, which the manager then deletes
+    manager = new LocalSmoozikManager(8198, false);
+    SmoozikReply *reply = manager->send("getTopTracks");
+    QTest::qWait(100);
+    QCOMPARE(manager->inFlightRequestCount(), 1);
+    delete reply;
+    QCOMPARE(manager->inFlightRequestCount(), 0);
+    delete manager;
+}
+
 QTEST_XML_MAIN(TestSmoozikManager)
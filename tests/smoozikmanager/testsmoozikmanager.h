@@ -42,11 +42,22 @@ private slots:
     void startParty();
     void joinParty();
     void sendPlaylist();
+    void updatePlaylist();
+    void sendPlaylistView();
     void setTrack();
     void unsetTrack();
     void unsetAllTracks();
     void getTopTracks();
     void forceDisconnectUsers();
+    void requestsPerHost();
+    void batch();
+    void endpoints();
+    void retry();
+    void circuitBreaker();
+    void deduplicateReads();
+    void cache();
+    void compression();
+    void deleteWithPendingRequests();
 };
 
 #endif // TESTSMOOZIKMANAGER_H
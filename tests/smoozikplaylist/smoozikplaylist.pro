@@ -1,7 +1,9 @@
 include(../tests.pri)
 
 HEADERS += \
-    testsmoozikplaylist.h
+    testsmoozikplaylist.h \
+    ../simplehttpserver.h
 
 SOURCES += \
-    testsmoozikplaylist.cpp
+    testsmoozikplaylist.cpp \
+    ../simplehttpserver.cpp
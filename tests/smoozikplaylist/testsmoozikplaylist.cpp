@@ -21,6 +21,7 @@
 #include "testsmoozikplaylist.h"
 #include "smoozikplaylist.h"
 #include "smoozikxml.h"
+#include "simplehttpserver.h"
 
 void TestSmoozikPlaylist::constructors()
 {
@@ -111,6 +112,140 @@ void TestSmoozikPlaylist::addTracks()
     QCOMPARE(playlist.count(), 3);
 }
 
+void TestSmoozikPlaylist::addTracksBulk()
+{
+    SmoozikPlaylist playlist;
+    playlist.addTrack("1", "track1");
+    playlist.removeAt(0);
+    playlist.addTrack("2", "track2");
+
+    QList<SmoozikTrackData> tracks;
+    tracks << SmoozikTrackData("1", "track1", "artist1")
+           << SmoozikTrackData("2", "duplicate")
+           << SmoozikTrackData("3", "track3", QString(), QString(), 0, "file3")
+           << SmoozikTrackData("1", "duplicate")
+           << SmoozikTrackData("4", "track4");
+
+    QList<int> duplicates = playlist.addTracks(tracks);
+    QCOMPARE(duplicates, QList<int>() << 1 << 3);
+    QCOMPARE(playlist.count(), 4);
+    QCOMPARE(playlist.trackData(0).name(), QString("track2"));
+    QCOMPARE(playlist.trackData(1), tracks.at(0));
+    QCOMPARE(playlist.indexOf("3"), 2);
+    QCOMPARE(playlist.indexOf("4"), 3);
+    QCOMPARE(playlist.indexByFileName("file3"), 2);
+    QCOMPARE(playlist.children().count(), 0);
+
+    QCOMPARE(playlist.addTracks(QList<SmoozikTrackData>()), QList<int>());
+    QCOMPARE(playlist.addTracks(tracks), QList<int>() << 0 << 1 << 2 << 3 << 4);
+    QCOMPARE(playlist.count(), 4);
+}
+
+void TestSmoozikPlaylist::trackData()
+{
+    SmoozikPlaylist playlist;
+    playlist.addTrack(SmoozikTrackData("1", "track1", "artist1", "album1", 220));
+    playlist.addTrack("2", "track2");
+    playlist.addTrack(SmoozikTrackData("1", "duplicate"));
+    QCOMPARE(playlist.count(), 2);
+    QCOMPARE(playlist.trackData(0).name(), QString("track1"));
+    QCOMPARE(playlist.trackData(1).localId(), QString("2"));
+    QCOMPARE(playlist.trackData(2).isNull(), true);
+    QCOMPARE(playlist.tracks().count(), 2);
+
+    // Track objects are only created on access
+    QCOMPARE(playlist.children().count(), 0);
+    SmoozikTrack *track = playlist.value(1);
+    QCOMPARE(playlist.children().count(), 1);
+    QCOMPARE(track->parent(), (QObject *)&playlist);
+    QCOMPARE(track->data(), playlist.trackData(1));
+    QCOMPARE(playlist.value(1), track);
+    QVERIFY(playlist.value(2) == 0);
+
+    SmoozikTrack object("3", "track3", this);
+    playlist.addTrack(&object);
+    QCOMPARE(playlist.trackData(2), object.data());
+    QCOMPARE(playlist.value(2), &object);
+
+    playlist.removeAt(0);
+    QCOMPARE(playlist.value(0), track);
+    QCOMPARE(playlist.trackData(0).localId(), QString("2"));
+}
+
+void TestSmoozikPlaylist::fromReply()
+{
+    SimpleHttpServer server(8193);
+    server.setResponse("<smoozik><status>ok</status><data><tracks>"
+                       "<track><localId>1</localId><name>track1</name><artist>artist1</artist><album>album1</album><duration>220</duration></track>"
+                       "<track><localId>2</localId><name>track2 &amp; &lt;b&gt;</name><unknown><a>b</a></unknown></track>"
+                       "<track><localId>1</localId><name>duplicate</name></track>"
+                       "<track><localId>3</localId><name><![CDATA[track3]]></name><fileName> </fileName><duration>12</duration></track>"
+                       "</tracks></data></smoozik>");
+
+    QNetworkAccessManager manager;
+    QNetworkRequest request(QUrl("http://127.0.0.1:8193"));
+
+    // Reference: variant tree
+    QNetworkReply *reply = manager.get(request);
+    for (int i = 0; i < 100 && !reply->isFinished(); i++) {
+        QTest::qWait(50);
+    }
+    SmoozikXml xml;
+    QCOMPARE(xml.parse(reply), true);
+    SmoozikPlaylist expected(xml["tracks"].toList());
+
+    reply = manager.get(request);
+    for (int i = 0; i < 100 && !reply->isFinished(); i++) {
+        QTest::qWait(50);
+    }
+    QPointer<QNetworkReply> guard(reply);
+    SmoozikPlaylist *playlist = SmoozikPlaylist::fromReply(reply, this);
+    QVERIFY(playlist != 0);
+    QCOMPARE(playlist->parent(), (QObject *)this);
+    QCOMPARE(playlist->count(), 3);
+    QCOMPARE(playlist->count(), expected.count());
+    for (int i = 0; i < expected.count(); i++) {
+        QCOMPARE(playlist->value(i)->localId(), expected.value(i)->localId());
+        QCOMPARE(playlist->value(i)->name(), expected.value(i)->name());
+        QCOMPARE(playlist->value(i)->artist(), expected.value(i)->artist());
+        QCOMPARE(playlist->value(i)->album(), expected.value(i)->album());
+        QCOMPARE(playlist->value(i)->duration(), expected.value(i)->duration());
+        QCOMPARE(playlist->value(i)->fileName(), expected.value(i)->fileName());
+        QCOMPARE(playlist->value(i)->parent(), (QObject *)playlist);
+    }
+    QCOMPARE(playlist->value(1)->name(), QString("track2 & <b>"));
+    delete playlist;
+
+    // Reply is deleted once parsed
+    QTest::qWait(0);
+    QCOMPARE(guard.isNull(), true);
+
+    // Errors
+    server.setResponse("<smoozik><status>failed</status><error><code>3</code><message>Authentication Failed</message></error></smoozik>");
+    reply = manager.get(request);
+    for (int i = 0; i < 100 && !reply->isFinished(); i++) {
+        QTest::qWait(50);
+    }
+    QVERIFY(xml.parseTracks(reply) == 0);
+    QCOMPARE(xml.error(), SmoozikManager::AuthenticationFailed);
+    QCOMPARE(xml.errorMsg(), QString("Authentication Failed"));
+
+    server.setResponse("<smoozik><status>ok</status><data><tracks><track>");
+    reply = manager.get(request);
+    for (int i = 0; i < 100 && !reply->isFinished(); i++) {
+        QTest::qWait(50);
+    }
+    QVERIFY(xml.parseTracks(reply) == 0);
+    QCOMPARE(xml.error(), SmoozikManager::ParseError);
+
+    server.setResponse("<smoozik><status>ok</status></smoozik>");
+    reply = manager.get(request);
+    for (int i = 0; i < 100 && !reply->isFinished(); i++) {
+        QTest::qWait(50);
+    }
+    QVERIFY(SmoozikPlaylist::fromReply(reply) == 0);
+}
+
 void TestSmoozikPlaylist::qListAggregation()
 {
     SmoozikPlaylist playlist;
@@ -207,18 +342,164 @@ void TestSmoozikPlaylist::indexByFileName()
     QCOMPARE(playlist.indexByFileName("error"), -1);
 }
 
+void TestSmoozikPlaylist::indexes()
+{
+    SmoozikPlaylist playlist;
+    for (int i = 0; i < 10; i++) {
+        playlist.addTrack(QString::number(i), "track", QString(), QString(), 0, QString("file%1").arg(i % 5));
+    }
+    QCOMPARE(playlist.indexOf("7"), 7);
+    QCOMPARE(playlist.indexByFileName("file2"), 2);
+
+    playlist.removeLast(); //list: 0 .. 8
+    QCOMPARE(playlist.contains("9"), false);
+    QCOMPARE(playlist.indexOf("8"), 8);
+    QCOMPARE(playlist.indexByFileName("file4"), 4);
+
+    playlist.removeAt(2); //list: 0, 1, 3 .. 8
+    QCOMPARE(playlist.contains("2"), false);
+    QCOMPARE(playlist.indexOf("3"), 2);
+    QCOMPARE(playlist.indexByFileName("file2"), 6);
+
+    QCOMPARE(playlist.takeFirst()->localId(), QString("0")); //list: 1, 3 .. 8
+    QCOMPARE(playlist.indexOf("1"), 0);
+    QCOMPARE(playlist.indexByFileName("file0"), 3);
+    QCOMPARE(playlist.takeLast()->localId(), QString("8")); //list: 1, 3 .. 7
+    QCOMPARE(playlist.indexOf("8"), -1);
+    QCOMPARE(playlist.indexByFileName("file3"), 1);
+
+    // Removed tracks can be added again
+    playlist.addTrack("0", "track0", QString(), QString(), 0, "file0");
+    QCOMPARE(playlist.indexOf("0"), 6);
+    QCOMPARE(playlist.indexByFileName("file0"), 3);
+    playlist.addTrack("3", "duplicate");
+    QCOMPARE(playlist.count(), 7);
+
+    playlist.clear();
+    QCOMPARE(playlist.contains("1"), false);
+    QCOMPARE(playlist.indexByFileName("file1"), -1);
+    playlist.addTrack("1", "track1");
+    QCOMPARE(playlist.indexOf("1"), 0);
+    QCOMPARE(playlist.indexByFileName(QString()), 0);
+}
+
+void TestSmoozikPlaylist::addTracksBenchmark()
+{
+    QVariantList list;
+    for (int i = 0; i < 50000; i++) {
+        QVariantMap track;
+        track.insert("localId", QString::number(i));
+        track.insert("name", QString("track%1").arg(i));
+        QVariantMap item;
+        item.insert("track", track);
+        list.append(item);
+    }
+
+    QBENCHMARK {
+        SmoozikPlaylist playlist(list);
+        QCOMPARE(playlist.count(), 50000);
+    }
+}
+
 void TestSmoozikPlaylist::random()
 {
     SmoozikPlaylist playlist;
+    QVERIFY(playlist.random() == 0);
+    QCOMPARE(playlist.randomIndex(), -1);
+
     playlist.addTrack("1", "track1");
     playlist.addTrack("2", "track2");
     playlist.addTrack("3", "track3");
     QString localId = playlist.random()->localId();
     QCOMPARE(localId.isEmpty(), false);
-    for (int __i = 0; __i < 5000 && (localId == playlist.random()->localId() != true); __i+= 50) {
-        QTest::qWait(50);
+
+    // Back-to-back calls do not repeat the same track
+    QSet<QString> localIds;
+    for (int i = 0; i < 100; i++) {
+        localIds.insert(playlist.random()->localId());
+    }
+    QCOMPARE(localIds.size(), 3);
+
+    // Seeding reproduces the sequence
+    QList<int> sequence;
+    playlist.setSeed(42);
+    for (int i = 0; i < 20; i++) {
+        sequence.append(playlist.randomIndex());
+    }
+    playlist.setSeed(42);
+    for (int i = 0; i < 20; i++) {
+        QCOMPARE(playlist.randomIndex(), sequence.at(i));
+    }
+}
+
+void TestSmoozikPlaylist::shuffledIndexes()
+{
+    SmoozikPlaylist playlist;
+    QCOMPARE(playlist.shuffledIndexes(), QList<int>());
+    for (int i = 0; i < 50; i++) {
+        playlist.addTrack(QString::number(i), "track");
+    }
+
+    playlist.setSeed(1);
+    QList<int> indexes = playlist.shuffledIndexes();
+    QCOMPARE(indexes.size(), 50);
+    QList<int> sorted = indexes;
+    qSort(sorted);
+    for (int i = 0; i < 50; i++) {
+        QCOMPARE(sorted.at(i), i);
     }
-    QCOMPARE(localId == playlist.random()->localId(), true);
+    QVERIFY(indexes != sorted);
+
+    playlist.setSeed(1);
+    QCOMPARE(playlist.shuffledIndexes(), indexes);
+}
+
+void TestSmoozikPlaylist::sampleIndexes()
+{
+    SmoozikPlaylist playlist;
+    QCOMPARE(playlist.sampleIndexes(3), QList<int>());
+    for (int i = 0; i < 1000; i++) {
+        playlist.addTrack(QString::number(i), "track");
+    }
+
+    QCOMPARE(playlist.sampleIndexes(0), QList<int>());
+    for (int n = 0; n < 20; n++) {
+        QList<int> indexes = playlist.sampleIndexes(10);
+        QCOMPARE(indexes.size(), 10);
+        QCOMPARE(indexes.toSet().size(), 10);
+        foreach(int index, indexes) {
+            QVERIFY(index >= 0 && index < 1000);
+        }
+    }
+
+    // Sampling more than the playlist size returns every track once
+    QList<int> all = playlist.sampleIndexes(2000);
+    QCOMPARE(all.size(), 1000);
+    QCOMPARE(all.toSet().size(), 1000);
+}
+
+void TestSmoozikPlaylist::weightedIndex()
+{
+    SmoozikPlaylist playlist;
+    playlist.addTrack("1", "track1");
+    playlist.addTrack("2", "track2");
+    playlist.addTrack("3", "track3");
+
+    QCOMPARE(playlist.weightedIndex(SmoozikAliasTable()), -1);
+
+    SmoozikAliasTable weights(QVector<double>() << 1 << 0 << 3);
+    playlist.setSeed(7);
+    int counts[3] = {0, 0, 0};
+    for (int i = 0; i < 4000; i++) {
+        counts[playlist.weightedIndex(weights)]++;
+    }
+    QCOMPARE(counts[1], 0);
+    QVERIFY(counts[0] > 800 && counts[0] < 1200);
+    QVERIFY(counts[2] > 2800 && counts[2] < 3200);
+
+    // Weights beyond the playlist size are not returned
+    SmoozikAliasTable tooMany(QVector<double>() << 0 << 0 << 0 << 1);
+    QCOMPARE(playlist.weightedIndex(tooMany), -1);
 }
 
 QTEST_XML_MAIN(TestSmoozikPlaylist)
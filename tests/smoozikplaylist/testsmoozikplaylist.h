@@ -31,11 +31,19 @@ private slots:
     void constructors();
     void addTrack();
     void addTracks();
+    void addTracksBulk();
+    void trackData();
+    void fromReply();
     void qListAggregation();
     void deleteTracks();
     void childrenDeletion();
     void indexByFileName();
+    void indexes();
+    void addTracksBenchmark();
     void random();
+    void shuffledIndexes();
+    void sampleIndexes();
+    void weightedIndex();
 };
 
 #endif // TESTSMOOZIKPLAYLIST_H
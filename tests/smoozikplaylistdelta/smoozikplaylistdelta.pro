@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmoozikplaylistdelta.h
+
+SOURCES += \
+    testsmoozikplaylistdelta.cpp
@@ -0,0 +1,104 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmoozikplaylistdelta.h"
+#include "smoozikplaylistdelta.h"
+#include "smoozikplaylist.h"
+
+void TestSmoozikPlaylistDelta::compute()
+{
+    SmoozikPlaylist from;
+    from.addTrack("1", "track1", "artist1", "album1", 220);
+    from.addTrack("2", "track2", "artist2");
+    from.addTrack("3", "track3");
+    from.addTrack("4", "track4");
+
+    SmoozikPlaylist to;
+    to.addTrack("5", "track5");
+    to.addTrack("4", "track4");
+    to.addTrack("2", "track2", "artist2", "album2");
+    to.addTrack("1", "track1", "artist1", "album1", 220);
+    to.addTrack("6", "track6", QString(), QString(), 0, "file6");
+
+    SmoozikPlaylistDelta delta(&from, &to);
+    QCOMPARE(delta.isEmpty(), false);
+    QCOMPARE(delta.count(), 4);
+    QCOMPARE(delta.added().size(), 2);
+    QCOMPARE(delta.added().at(0), to.trackData(0));
+    QCOMPARE(delta.added().at(1), to.trackData(4));
+    QCOMPARE(delta.changed().size(), 1);
+    QCOMPARE(delta.changed().at(0).album(), QString("album2"));
+    QCOMPARE(delta.removed(), QStringList() << "3");
+
+    // Reverse delta
+    delta.compute(&to, &from);
+    QCOMPARE(delta.added().size(), 1);
+    QCOMPARE(delta.added().at(0).localId(), QString("3"));
+    QCOMPARE(delta.changed().size(), 1);
+    QCOMPARE(delta.changed().at(0).album(), QString());
+    QCOMPARE(delta.removed(), QStringList() << "5" << "6");
+
+    // Order is not a change
+    delta.compute(&from, &from);
+    QCOMPARE(delta.isEmpty(), true);
+    SmoozikPlaylist reordered;
+    reordered.addTrack(from.trackData(3));
+    reordered.addTrack(from.trackData(2));
+    reordered.addTrack(from.trackData(1));
+    reordered.addTrack(from.trackData(0));
+    delta.compute(&from, &reordered);
+    QCOMPARE(delta.isEmpty(), true);
+
+    // Neither is a new fileName, which the server never sees
+    SmoozikPlaylist moved;
+    moved.addTrack("1", "track1", "artist1", "album1", 220, "moved1");
+    SmoozikPlaylist original;
+    original.addTrack(from.trackData(0));
+    delta.compute(&original, &moved);
+    QCOMPARE(delta.isEmpty(), true);
+}
+
+void TestSmoozikPlaylistDelta::emptyPlaylists()
+{
+    SmoozikPlaylistDelta delta;
+    QCOMPARE(delta.isEmpty(), true);
+    QCOMPARE(delta.count(), 0);
+
+    SmoozikPlaylist empty;
+    SmoozikPlaylist playlist;
+    playlist.addTrack("1", "track1");
+    playlist.addTrack("2", "track2");
+
+    delta.compute(0, &playlist);
+    QCOMPARE(delta.added().size(), 2);
+    QCOMPARE(delta.removed().size(), 0);
+
+    delta.compute(&empty, &playlist);
+    QCOMPARE(delta.added().size(), 2);
+
+    delta.compute(&playlist, &empty);
+    QCOMPARE(delta.added().size(), 0);
+    QCOMPARE(delta.removed(), QStringList() << "1" << "2");
+
+    delta.compute(&empty, &empty);
+    QCOMPARE(delta.isEmpty(), true);
+}
+
+QTEST_XML_MAIN(TestSmoozikPlaylistDelta)
@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmoozikplaylistsnapshot.h
+
+SOURCES += \
+    testsmoozikplaylistsnapshot.cpp
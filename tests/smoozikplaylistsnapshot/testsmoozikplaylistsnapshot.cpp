@@ -0,0 +1,158 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmoozikplaylistsnapshot.h"
+#include "smoozikplaylistsnapshot.h"
+#include "smoozikplaylist.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+
+void TestSmoozikPlaylistSnapshot::crc32()
+{
+    QCOMPARE(SmoozikPlaylistSnapshot::crc32("123456789", 9), (quint32)0xCBF43926);
+    QCOMPARE(SmoozikPlaylistSnapshot::crc32("", 0), (quint32)0);
+}
+
+void TestSmoozikPlaylistSnapshot::saveLoad()
+{
+    SmoozikPlaylist playlist;
+    playlist.addTrack("1", "track1", "artist1", "album1", 220, "/music/track1.mp3");
+    playlist.addTrack("2", QString::fromUtf8("tr\xc3\xa0" "ck2 & <b>"), "artist1", "album1", 180);
+    playlist.addTrack("3", "track3");
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    SmoozikPlaylistSnapshot snapshot;
+    QCOMPARE(snapshot.save(&playlist, &buffer), true);
+    QCOMPARE(snapshot.errorString(), QString());
+    QCOMPARE(buffer.data().left(4), QByteArray("SMZP"));
+
+    SmoozikPlaylist loaded;
+    QCOMPARE(snapshot.load(buffer.data(), &loaded), true);
+    QCOMPARE(snapshot.errorString(), QString());
+    QCOMPARE(loaded.count(), 3);
+    for (int i = 0; i < 3; i++) {
+        QCOMPARE(loaded.trackData(i), playlist.trackData(i));
+    }
+    QCOMPARE(loaded.trackData(2).artist().isEmpty(), true);
+
+    // Shared strings are decoded once
+    QCOMPARE(loaded.trackData(0).artist().constData(), loaded.trackData(1).artist().constData());
+
+    // Without cache, records are read from the snapshot data on each access
+    SmoozikPlaylistSnapshot reader;
+    reader.setCacheStrings(false);
+    QCOMPARE(reader.open(buffer.data()), true);
+    QCOMPARE(reader.count(), 3);
+    QCOMPARE(reader.trackData(1), playlist.trackData(1));
+    QCOMPARE(reader.localIdBytes(1), QByteArray("2"));
+    QCOMPARE(reader.fileNameBytes(0), QByteArray("/music/track1.mp3"));
+    QVERIFY(reader.trackData(0).artist().constData() != reader.trackData(1).artist().constData());
+    reader.close();
+
+    // Empty playlist
+    SmoozikPlaylist empty;
+    QBuffer emptyBuffer;
+    emptyBuffer.open(QIODevice::WriteOnly);
+    QCOMPARE(snapshot.save(&empty, &emptyBuffer), true);
+    QCOMPARE(snapshot.load(emptyBuffer.data(), &loaded), true);
+    QCOMPARE(loaded.count(), 3);
+}
+
+void TestSmoozikPlaylistSnapshot::file()
+{
+    QString fileName = QDir::temp().filePath("testsmoozikplaylistsnapshot.smzp");
+    SmoozikPlaylist playlist;
+    for (int i = 0; i < 100; i++) {
+        playlist.addTrack(QString::number(i), QString("track%1").arg(i), QString("artist%1").arg(i % 7), QString(), i, QString("file%1").arg(i));
+    }
+    QCOMPARE(playlist.saveSnapshot(fileName), true);
+
+    SmoozikPlaylist *loaded = SmoozikPlaylist::fromSnapshot(fileName, this);
+    QVERIFY(loaded != 0);
+    QCOMPARE(loaded->parent(), (QObject *)this);
+    QCOMPARE(loaded->tracks(), playlist.tracks());
+    QCOMPARE(loaded->indexByFileName("file42"), 42);
+    delete loaded;
+
+    QFile::remove(fileName);
+    QVERIFY(SmoozikPlaylist::fromSnapshot(fileName) == 0);
+    SmoozikPlaylistSnapshot snapshot;
+    SmoozikPlaylist playlist2;
+    QCOMPARE(snapshot.load(fileName, &playlist2), false);
+    QCOMPARE(snapshot.errorString().isEmpty(), false);
+}
+
+void TestSmoozikPlaylistSnapshot::corruption()
+{
+    SmoozikPlaylist playlist;
+    playlist.addTrack("1", "track1", "artist1", "album1", 220);
+    playlist.addTrack("2", "track2", "artist2");
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    SmoozikPlaylistSnapshot snapshot;
+    QCOMPARE(snapshot.save(&playlist, &buffer), true);
+    QByteArray data = buffer.data();
+
+    SmoozikPlaylist loaded;
+    QCOMPARE(snapshot.load(QByteArray(), &loaded), false);
+    QCOMPARE(snapshot.load(QByteArray("not a snapshot at all, not at all"), &loaded), false);
+
+    QByteArray corrupted = data;
+    corrupted[corrupted.size() - 2] = corrupted.at(corrupted.size() - 2) ^ 0x20;
+    QCOMPARE(snapshot.load(corrupted, &loaded), false);
+    QCOMPARE(snapshot.errorString(), QString("Snapshot checksum mismatch"));
+
+    QCOMPARE(snapshot.load(data.left(data.size() - 1), &loaded), false);
+    QCOMPARE(snapshot.errorString(), QString("Truncated or corrupted snapshot"));
+
+    QByteArray version = data;
+    version[4] = 2;
+    QCOMPARE(snapshot.load(version, &loaded), false);
+    QCOMPARE(snapshot.errorString(), QString("Unsupported snapshot version 2"));
+
+    QCOMPARE(loaded.isEmpty(), true);
+    QCOMPARE(snapshot.load(data, &loaded), true);
+    QCOMPARE(loaded.count(), 2);
+}
+
+void TestSmoozikPlaylistSnapshot::loadBenchmark()
+{
+    QString fileName = QDir::temp().filePath("testsmoozikplaylistsnapshotbenchmark.smzp");
+    SmoozikPlaylist playlist;
+    QList<SmoozikTrackData> tracks;
+    for (int i = 0; i < 50000; i++) {
+        tracks.append(SmoozikTrackData(QString::number(i), QString("track%1").arg(i), QString("artist%1").arg(i % 1000), QString("album%1").arg(i % 3000), 180, QString("/music/file%1.mp3").arg(i)));
+    }
+    playlist.addTracks(tracks);
+    QCOMPARE(playlist.saveSnapshot(fileName), true);
+
+    QBENCHMARK {
+        SmoozikPlaylist *loaded = SmoozikPlaylist::fromSnapshot(fileName);
+        QCOMPARE(loaded->count(), 50000);
+        delete loaded;
+    }
+    QFile::remove(fileName);
+}
+
+QTEST_XML_MAIN(TestSmoozikPlaylistSnapshot)
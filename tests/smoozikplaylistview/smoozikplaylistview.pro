@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmoozikplaylistview.h
+
+SOURCES += \
+    testsmoozikplaylistview.cpp
@@ -0,0 +1,128 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmoozikplaylistview.h"
+#include "smoozikplaylistview.h"
+#include "smoozikplaylist.h"
+
+void TestSmoozikPlaylistView::addTrack()
+{
+    SmoozikPlaylist playlist;
+    playlist.addTrack("1", "track1", "artist1", "album1", 220);
+    playlist.addTrack("2", "track2");
+    playlist.addTrack("3", "track3");
+    SmoozikTrackCatalog catalog;
+    QCOMPARE(catalog.load(&playlist), true);
+
+    SmoozikPlaylistView view(&catalog);
+    QCOMPARE(view.catalog(), (const SmoozikTrackCatalog *)&catalog);
+    QCOMPARE(view.isEmpty(), true);
+    QCOMPARE(view.addTrack(2), true);
+    QCOMPARE(view.addTrack("1"), true);
+    QCOMPARE(view.addTrack(2), false);
+    QCOMPARE(view.addTrack("3"), false);
+    QCOMPARE(view.addTrack(3), false);
+    QCOMPARE(view.addTrack("4"), false);
+    QCOMPARE(view.count(), 2);
+    QCOMPARE(view.size(), 2);
+    QCOMPARE(view.catalogIndex(0), (quint32)2);
+    QCOMPARE(view.catalogIndexes(), QVector<quint32>() << 2 << 0);
+    QCOMPARE(view.trackData(0), playlist.trackData(2));
+    QCOMPARE(view.trackData(1), playlist.trackData(0));
+    QCOMPARE(view.trackData(2).isNull(), true);
+}
+
+void TestSmoozikPlaylistView::queries()
+{
+    SmoozikPlaylist playlist;
+    for (int i = 0; i < 10; i++) {
+        playlist.addTrack(QString::number(i), QString("track%1").arg(i), QString(), QString(), 0, QString("file%1").arg(i));
+    }
+    SmoozikTrackCatalog catalog;
+    QCOMPARE(catalog.load(&playlist), true);
+
+    SmoozikPlaylistView view(&catalog);
+    view.addTrack(7);
+    view.addTrack(3);
+    view.addTrack(5);
+    view.addTrack(1);
+
+    QCOMPARE(view.contains("3"), true);
+    QCOMPARE(view.contains("4"), false);
+    QCOMPARE(view.indexOf("5"), 2);
+    QCOMPARE(view.indexOf("error"), -1);
+    QCOMPARE(view.indexByFileName("file1"), 3);
+    QCOMPARE(view.indexByFileName("file2"), -1);
+
+    view.removeFirst(); //list: 3, 5, 1
+    QCOMPARE(view.indexOf("3"), 0);
+    QCOMPARE(view.indexByFileName("file1"), 2);
+    QCOMPARE(view.indexByFileName("file7"), -1);
+    view.removeLast(); //list: 3, 5
+    QCOMPARE(view.contains("1"), false);
+    view.removeAt(0); //list: 5
+    QCOMPARE(view.tracks().size(), 1);
+    QCOMPARE(view.tracks().first(), playlist.trackData(5));
+    QCOMPARE(view.indexOf("5"), 0);
+
+    // Removed tracks can be added again
+    QCOMPARE(view.addTrack(7), true);
+    QCOMPARE(view.addTrack(5), false);
+    QCOMPARE(view.indexOf("7"), 1);
+    view.removeFirst(); //list: 7
+    QCOMPARE(view.indexOf("7"), 0);
+    QCOMPARE(view.indexOf("5"), -1);
+    QCOMPARE(view.tracks().first(), playlist.trackData(7));
+
+    SmoozikPlaylist *copy = view.toPlaylist(this);
+    QCOMPARE(copy->parent(), (QObject *)this);
+    QCOMPARE(copy->tracks(), view.tracks());
+    delete copy;
+
+    view.clear();
+    QCOMPARE(view.isEmpty(), true);
+}
+
+void TestSmoozikPlaylistView::sharedCatalog()
+{
+    SmoozikPlaylist playlist;
+    for (int i = 0; i < 1000; i++) {
+        playlist.addTrack(QString::number(i), QString("track%1").arg(i), QString("artist%1").arg(i % 10));
+    }
+    SmoozikTrackCatalog catalog;
+    QCOMPARE(catalog.load(&playlist), true);
+
+    // Several parties pick their tracks from the same catalog
+    SmoozikPlaylistView party1(&catalog);
+    SmoozikPlaylistView party2(&catalog);
+    for (quint32 i = 0; i < MAX_ADVISED_PLAYLIST_SIZE; i++) {
+        party1.addTrack(i);
+        party2.addTrack(999 - i);
+    }
+    QCOMPARE(party1.count(), MAX_ADVISED_PLAYLIST_SIZE);
+    QCOMPARE(party2.count(), MAX_ADVISED_PLAYLIST_SIZE);
+    QCOMPARE(party1.trackData(10).localId(), QString("10"));
+    QCOMPARE(party2.trackData(10).localId(), QString("989"));
+
+    // Shared strings are decoded once for all views
+    QCOMPARE(party1.trackData(9).artist().constData(), party2.trackData(0).artist().constData());
+}
+
+QTEST_XML_MAIN(TestSmoozikPlaylistView)
@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmoozikrandom.h
+
+SOURCES += \
+    testsmoozikrandom.cpp
@@ -0,0 +1,114 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmoozikrandom.h"
+#include "smoozikrandom.h"
+
+void TestSmoozikRandom::seed()
+{
+    SmoozikRandom random1(12345);
+    SmoozikRandom random2(12345);
+    SmoozikRandom random3(54321);
+    bool differs = false;
+    for (int i = 0; i < 100; i++) {
+        quint32 value = random1.next();
+        QCOMPARE(random2.next(), value);
+        differs |= (random3.next() != value);
+    }
+    QVERIFY(differs);
+
+    random1.seed(12345);
+    random2.seed(12345);
+    QCOMPARE(random1.next(), random2.next());
+
+    // Default constructed generators are seeded differently
+    SmoozikRandom random4;
+    SmoozikRandom random5;
+    QVERIFY(random4.next() != random5.next() || random4.next() != random5.next());
+}
+
+void TestSmoozikRandom::bounded()
+{
+    SmoozikRandom random(1);
+    QCOMPARE(random.bounded(0), 0);
+    QCOMPARE(random.bounded(-3), 0);
+    QCOMPARE(random.bounded(1), 0);
+
+    int counts[6] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 6000; i++) {
+        int value = random.bounded(6);
+        QVERIFY(value >= 0 && value < 6);
+        counts[value]++;
+    }
+    for (int i = 0; i < 6; i++) {
+        QVERIFY(counts[i] > 800 && counts[i] < 1200);
+    }
+}
+
+void TestSmoozikRandom::real()
+{
+    SmoozikRandom random(2);
+    double sum = 0;
+    for (int i = 0; i < 10000; i++) {
+        double value = random.real();
+        QVERIFY(value >= 0 && value < 1);
+        sum += value;
+    }
+    QVERIFY(sum > 4800 && sum < 5200);
+}
+
+void TestSmoozikRandom::aliasTable()
+{
+    SmoozikRandom random(3);
+    SmoozikAliasTable table(QVector<double>() << 2 << 0 << 1 << -4 << 1);
+    QCOMPARE(table.count(), 5);
+    QCOMPARE(table.isEmpty(), false);
+
+    int counts[5] = {0, 0, 0, 0, 0};
+    for (int i = 0; i < 8000; i++) {
+        counts[table.sample(random)]++;
+    }
+    QCOMPARE(counts[1], 0);
+    QCOMPARE(counts[3], 0);
+    QVERIFY(counts[0] > 3600 && counts[0] < 4400);
+    QVERIFY(counts[2] > 1700 && counts[2] < 2300);
+    QVERIFY(counts[4] > 1700 && counts[4] < 2300);
+
+    table.setWeights(QVector<double>() << 0 << 5);
+    QCOMPARE(table.count(), 2);
+    for (int i = 0; i < 100; i++) {
+        QCOMPARE(table.sample(random), 1);
+    }
+}
+
+void TestSmoozikRandom::aliasTableEmpty()
+{
+    SmoozikRandom random;
+    SmoozikAliasTable table;
+    QCOMPARE(table.isEmpty(), true);
+    QCOMPARE(table.sample(random), -1);
+
+    table.setWeights(QVector<double>() << 0 << -1);
+    QCOMPARE(table.isEmpty(), true);
+    QCOMPARE(table.count(), 0);
+    QCOMPARE(table.sample(random), -1);
+}
+
+QTEST_XML_MAIN(TestSmoozikRandom)
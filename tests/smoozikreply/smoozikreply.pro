@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmoozikreply.h \
+    ../simplehttpserver.h \
+    ../localsmoozikmanager.h
+
+SOURCES += \
+    testsmoozikreply.cpp \
+    ../simplehttpserver.cpp
@@ -0,0 +1,127 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmoozikreply.h"
+#include "smoozikreply.h"
+#include "smoozikxml.h"
+#include "simplehttpserver.h"
+
+#define PARTY_RESPONSE "<smoozik><status>ok</status><data><party><id>1</id></party></data></smoozik>"
+
+void TestSmoozikReply::finished()
+{
+    SimpleHttpServer server(8182);
+    server.setResponse(PARTY_RESPONSE);
+    LocalSmoozikManager manager(8182, false);
+    QSignalSpy requestFinishedSpy(&manager, SIGNAL(requestFinished(QNetworkReply*)));
+
+    SmoozikReply *reply = manager.send("startParty");
+    QSignalSpy finishedSpy(reply, SIGNAL(finished()));
+    QCOMPARE(reply->method(), QString("startParty"));
+    QCOMPARE(reply->isFinished(), false);
+
+    QCOMPARE(reply->waitForFinished(5000), true);
+    QCOMPARE(reply->isFinished(), true);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(requestFinishedSpy.count(), 1);
+    QCOMPARE(reply->url().path().endsWith("startParty"), true);
+
+    SmoozikXml xml;
+    QCOMPARE(xml.parse(reply), true);
+    QCOMPARE(xml["party"].toMap()["id"].toString(), QString("1"));
+}
+
+void TestSmoozikReply::blocking()
+{
+    SimpleHttpServer server(8182);
+    server.setResponse(PARTY_RESPONSE);
+    LocalSmoozikManager manager(8182, true);
+
+    QNetworkReply *reply = manager.startParty();
+    QCOMPARE(reply->isFinished(), true);
+    QCOMPARE(server.requestCount(), 1);
+
+    SmoozikXml xml;
+    QCOMPARE(xml.parse(reply), true);
+    QCOMPARE(xml["party"].isNull(), false);
+}
+
+void TestSmoozikReply::independentWaits()
+{
+    SimpleHttpServer server(8182);
+    server.setResponse(PARTY_RESPONSE);
+    LocalSmoozikManager manager(8182, false);
+
+    SmoozikReply *reply1 = manager.send("startParty");
+    SmoozikReply *reply2 = manager.send("getTopTracks");
+
+    QCOMPARE(reply2->waitForFinished(5000), true);
+    QCOMPARE(reply2->method(), QString("getTopTracks"));
+    QCOMPARE(reply1->waitForFinished(5000), true);
+    QCOMPARE(server.requestCount(), 2);
+
+    QCOMPARE(reply1->readAll().contains("<party>"), true);
+    QCOMPARE(reply2->readAll().contains("<party>"), true);
+    reply1->deleteLater();
+    reply2->deleteLater();
+}
+
+void TestSmoozikReply::deadline()
+{
+    // This server accepts connections but never answers.
+    QTcpServer silentServer;
+    silentServer.listen(QHostAddress("127.0.0.1"), 8183);
+
+    LocalSmoozikManager manager(8183, true);
+    manager.setTimeout(200);
+
+    QTime time;
+    time.start();
+    QNetworkReply *reply = manager.startParty();
+    QCOMPARE(time.elapsed() < 5000, true);
+    QCOMPARE(reply->isFinished(), true);
+    QCOMPARE(reply->error(), QNetworkReply::OperationCanceledError);
+
+    SmoozikXml xml;
+    QCOMPARE(xml.parse(reply), false);
+    QCOMPARE(xml.error(), SmoozikManager::ServerUnreachable);
+}
+
+void TestSmoozikReply::abort()
+{
+    QTcpServer silentServer;
+    silentServer.listen(QHostAddress("127.0.0.1"), 8183);
+
+    LocalSmoozikManager manager(8183, false);
+    SmoozikReply *reply = manager.send("startParty");
+    QSignalSpy finishedSpy(reply, SIGNAL(finished()));
+
+    QCOMPARE(reply->waitForFinished(100), false);
+    QCOMPARE(reply->isFinished(), false);
+
+    reply->abort();
+    QCOMPARE(reply->isFinished(), true);
+    QCOMPARE(reply->error(), QNetworkReply::OperationCanceledError);
+    QCOMPARE(finishedSpy.count(), 1);
+    reply->deleteLater();
+}
+
+QTEST_XML_MAIN(TestSmoozikReply)
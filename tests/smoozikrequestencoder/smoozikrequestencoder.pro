@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmoozikrequestencoder.h
+
+SOURCES += \
+    testsmoozikrequestencoder.cpp
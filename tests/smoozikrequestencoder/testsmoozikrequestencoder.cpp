@@ -0,0 +1,275 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmoozikrequestencoder.h"
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+#include <QUrlQuery>
+#endif
+
+typedef QMap<QString, QString> Params;
+typedef QList<QPair<QString, QString> > Items;
+
+Q_DECLARE_METATYPE(Params)
+
+/**
+ * @brief Encoding of SmoozikManager before SmoozikRequestEncoder, used as reference.
+ */
+static void legacyEncode(Params getParams, Params postParams, const QString &secret, QByteArray *encodedGetData, QByteArray *encodedPostData)
+{
+    getParams.insert("format", "xml");
+    postParams.insert("apiKey", "key");
+    postParams.insert("sessionKey", "session");
+
+    QStringList keyList;
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    QUrl postQuery;
+#else
+    QUrlQuery postQuery;
+#endif
+    QMapIterator<QString, QString> i(postParams);
+    while (i.hasNext()) {
+        i.next();
+        if (!i.value().isEmpty()) {
+            QString key = i.key();
+            QString value = i.value();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+            key.replace(QByteArray("%"), QByteArray("%25"));
+            value.replace(QByteArray("%"), QByteArray("%25"));
+#endif
+            postQuery.addQueryItem(key, value);
+            if (i.key() != "sig") {
+                keyList << i.key();
+            }
+        }
+    }
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    QUrl getData;
+#else
+    QUrlQuery getData;
+#endif
+    QMapIterator<QString, QString> j(getParams);
+    while (j.hasNext()) {
+        j.next();
+        if (!j.value().isEmpty()) {
+            QString key = j.key();
+            QString value = j.value();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+            key.replace(QByteArray("%"), QByteArray("%25"));
+            value.replace(QByteArray("%"), QByteArray("%25"));
+#endif
+            getData.addQueryItem(key, value);
+            if (j.key() != "sig") {
+                keyList << j.key();
+            }
+        }
+    }
+
+    keyList.sort();
+    QByteArray sigParams;
+    for (int k = 0; k < keyList.size(); k++) {
+        QByteArray key = keyList.value(k).toUtf8();
+        sigParams += key + getParams[key].toUtf8() + postParams[key].toUtf8();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(sigParams + secret.toUtf8());
+    QString sig = hash.result().toHex();
+    postQuery.addQueryItem("sig", sig);
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    *encodedGetData = getData.encodedQuery().replace(QByteArray("+"), QByteArray("%2B"));
+    *encodedPostData = postQuery.encodedQuery().replace(QByteArray("+"), QByteArray("%2B"));
+#else
+    *encodedGetData = getData.query(QUrl::FullyEncoded).toUtf8().replace(QByteArray("+"), QByteArray("%2B"));
+    *encodedPostData = postQuery.query(QUrl::FullyEncoded).toUtf8().replace(QByteArray("+"), QByteArray("%2B"));
+#endif
+}
+
+/**
+ * @brief Decodes form encoded @em data as the server does.
+ */
+static Items decode(const QByteArray &data)
+{
+    Items items;
+    if (data.isEmpty()) {
+        return items;
+    }
+
+    foreach(const QByteArray &item, data.split('&')) {
+        int separator = item.indexOf('=');
+        items << qMakePair(QUrl::fromPercentEncoding(item.left(separator)), QUrl::fromPercentEncoding(item.mid(separator + 1)));
+    }
+    return items;
+}
+
+static SmoozikRequestEncoder *newEncoder()
+{
+    SmoozikRequestEncoder *encoder = new SmoozikRequestEncoder();
+    encoder->setFixedGetParameter("format", "xml");
+    encoder->setFixedPostParameter("apiKey", "key");
+    encoder->setFixedPostParameter("sessionKey", "session");
+    return encoder;
+}
+
+void TestSmoozikRequestEncoder::toUtf8_data()
+{
+    QTest::addColumn<QString>("string");
+
+    QTest::newRow("Empty") << QString();
+    QTest::newRow("Ascii") << QString("Smoozik");
+    QTest::newRow("Latin") << QString::fromUtf8("Beyonc\xc3\xa9");
+    QTest::newRow("Cjk") << QString::fromUtf8("\xe6\xbc\xa2\xe5\xad\x97");
+    QTest::newRow("Surrogates") << QString::fromUtf8("\xf0\x9f\x8e\xb5 music");
+}
+
+void TestSmoozikRequestEncoder::toUtf8()
+{
+    QFETCH(QString, string);
+
+    QByteArray buffer("previous content");
+    SmoozikRequestEncoder::toUtf8(string, buffer);
+    QCOMPARE(buffer, string.toUtf8());
+}
+
+void TestSmoozikRequestEncoder::encode_data()
+{
+    QTest::addColumn<Params>("getParams");
+    QTest::addColumn<Params>("postParams");
+
+    Params get;
+    Params post;
+    QTest::newRow("No parameters") << get << post;
+
+    post.insert("partyId", "1");
+    post.insert("name", "Party");
+    QTest::newRow("Post parameters") << get << post;
+
+    get.insert("lastTouchDelay", "60");
+    QTest::newRow("Get parameters") << get << post;
+
+    post.insert("name", QString::fromUtf8("a+b%c d&e=f/g?h#i \xc3\xa9\xe6\xbc\xa2\xf0\x9f\x8e\xb5"));
+    QTest::newRow("Special characters") << get << post;
+
+    post.insert("empty", "");
+    get.insert("partyId", "2");
+    QTest::newRow("Key in both methods") << get << post;
+
+    get.insert("name", "");
+    post.insert("sig", "ignored");
+    QTest::newRow("Empty and sig") << get << post;
+
+    post.insert("apiKey", "overridden");
+    get.insert("format", "json");
+    QTest::newRow("Fixed parameters") << get << post;
+}
+
+void TestSmoozikRequestEncoder::encode()
+{
+    QFETCH(Params, getParams);
+    QFETCH(Params, postParams);
+
+    QByteArray legacyGetData;
+    QByteArray legacyPostData;
+    legacyEncode(getParams, postParams, "secret", &legacyGetData, &legacyPostData);
+
+    SmoozikRequestEncoder *encoder = newEncoder();
+
+    // Twice to check buffers are correctly reused
+    for (int i = 0; i < 2; i++) {
+        encoder->encode(getParams, postParams, "secret");
+        QCOMPARE(decode(encoder->getData()), decode(legacyGetData));
+        QCOMPARE(decode(encoder->postData()), decode(legacyPostData));
+        QCOMPARE(decode(encoder->postData()).last(), qMakePair(QString("sig"), QString(encoder->signature())));
+    }
+
+    delete encoder;
+}
+
+void TestSmoozikRequestEncoder::fixedParameters()
+{
+    SmoozikRequestEncoder encoder;
+    Params params;
+    params.insert("partyId", "1");
+
+    encoder.encode(params, Params(), QString());
+    QCOMPARE(encoder.getData(), QByteArray("partyId=1"));
+
+    encoder.setFixedGetParameter("format", "xml");
+    encoder.encode(params, Params(), QString());
+    QCOMPARE(encoder.getData(), QByteArray("format=xml&partyId=1"));
+
+    encoder.setFixedGetParameter("format", "json");
+    encoder.encode(params, Params(), QString());
+    QCOMPARE(encoder.getData(), QByteArray("format=json&partyId=1"));
+
+    // Empty fixed parameters are not sent
+    encoder.setFixedGetParameter("format", QString());
+    encoder.encode(params, Params(), QString());
+    QCOMPARE(encoder.getData(), QByteArray("partyId=1"));
+}
+
+void TestSmoozikRequestEncoder::benchmark_data()
+{
+    QTest::addColumn<bool>("legacy");
+
+    QTest::newRow("Legacy") << true;
+    QTest::newRow("Encoder") << false;
+}
+
+void TestSmoozikRequestEncoder::benchmark()
+{
+    QFETCH(bool, legacy);
+
+    // Parameters of sendPlaylist() with 200 tracks
+    Params postParams;
+    for (int i = 0; i < 200; i++) {
+        QString prefix = QString("tracks[%1]").arg(i);
+        postParams.insert(prefix + "[localId]", QString::number(i));
+        postParams.insert(prefix + "[name]", QString::fromUtf8("Track n\xc2\xb0%1 (Remix + Edit)").arg(i));
+        postParams.insert(prefix + "[artist]", QString::fromUtf8("Beyonc\xc3\xa9 & Jay-Z"));
+        postParams.insert(prefix + "[album]", QString("Album %1").arg(i / 10));
+    }
+    Params getParams;
+
+    QByteArray getData;
+    QByteArray postData;
+
+    if (legacy) {
+        QBENCHMARK {
+            legacyEncode(getParams, postParams, "secret", &getData, &postData);
+        }
+    } else {
+        SmoozikRequestEncoder *encoder = newEncoder();
+        QBENCHMARK {
+            encoder->encode(getParams, postParams, "secret");
+            getData = encoder->getData();
+            postData = encoder->postData();
+        }
+        delete encoder;
+    }
+
+    QVERIFY(!postData.isEmpty());
+}
+
+QTEST_XML_MAIN(TestSmoozikRequestEncoder)
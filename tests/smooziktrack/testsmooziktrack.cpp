@@ -78,6 +78,16 @@ void TestSmoozikTrack::constructors()
     QCOMPARE(track3.artist(), artist);
     QCOMPARE(track3.duration(), duration);
     QCOMPARE(track3.fileName(), fileName);
+
+    // Properties missing from the map are reset
+    SmoozikTrack track4("other", "other", 0, "other", "other", 1, "other");
+    track4.setPropertiesFromMap(variant.toMap());
+    QCOMPARE(track4.localId(), localId);
+    QCOMPARE(track4.name(), name);
+    QCOMPARE(track4.album(), album);
+    QCOMPARE(track4.artist(), artist);
+    QCOMPARE(track4.duration(), duration);
+    QCOMPARE(track4.fileName(), fileName);
 }
 
 QTEST_XML_MAIN(TestSmoozikTrack)
@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmooziktrackcatalog.h
+
+SOURCES += \
+    testsmooziktrackcatalog.cpp
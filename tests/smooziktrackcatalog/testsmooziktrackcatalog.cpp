@@ -0,0 +1,116 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmooziktrackcatalog.h"
+#include "smooziktrackcatalog.h"
+#include "smoozikplaylist.h"
+
+#include <QDir>
+#include <QFile>
+
+void TestSmoozikTrackCatalog::loadPlaylist()
+{
+    SmoozikTrackCatalog catalog;
+    QCOMPARE(catalog.isEmpty(), true);
+    QCOMPARE(catalog.count(), 0);
+    QCOMPARE(catalog.trackData(0).isNull(), true);
+
+    SmoozikPlaylist *playlist = new SmoozikPlaylist;
+    playlist->addTrack("1", "track1", "artist1", "album1", 220, "file1");
+    playlist->addTrack("2", "track2", "artist1");
+    playlist->addTrack("3", "track3");
+    QList<SmoozikTrackData> tracks = playlist->tracks();
+
+    QCOMPARE(catalog.load(playlist), true);
+    QCOMPARE(catalog.errorString(), QString());
+    delete playlist;
+
+    // Catalog does not depend on the playlist
+    QCOMPARE(catalog.count(), 3);
+    QCOMPARE(catalog.isEmpty(), false);
+    for (int i = 0; i < 3; i++) {
+        QCOMPARE(catalog.trackData(i), tracks.at(i));
+    }
+    QCOMPARE(catalog.localId(1), QString("2"));
+    QCOMPARE(catalog.fileName(0), QString("file1"));
+    QCOMPARE(catalog.fileNameBytes(0), QByteArray("file1"));
+    QCOMPARE(catalog.fileNameBytes(3).isNull(), true);
+    QCOMPARE(catalog.trackData(3).isNull(), true);
+    QCOMPARE(catalog.localId(3), QString());
+
+    catalog.clear();
+    QCOMPARE(catalog.isEmpty(), true);
+    QCOMPARE(catalog.indexOf("1"), -1);
+}
+
+void TestSmoozikTrackCatalog::loadFile()
+{
+    QString fileName = QDir::temp().filePath("testsmooziktrackcatalog.smzp");
+    SmoozikPlaylist playlist;
+    for (int i = 0; i < 1000; i++) {
+        playlist.addTrack(QString::number(i), QString("track%1").arg(i), QString("artist%1").arg(i % 10), QString(), i, QString("file%1").arg(i));
+    }
+    QCOMPARE(playlist.saveSnapshot(fileName), true);
+
+    SmoozikTrackCatalog catalog;
+    QCOMPARE(catalog.load(fileName), true);
+    QCOMPARE(catalog.count(), 1000);
+    QCOMPARE(catalog.trackData(999), playlist.trackData(999));
+    QCOMPARE(catalog.trackData(0), playlist.trackData(0));
+
+    // Loading a corrupted file empties the catalog
+    catalog.clear();
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    file.seek(file.size() - 1);
+    file.write("#");
+    file.close();
+    QCOMPARE(catalog.load(&playlist), true);
+    QCOMPARE(catalog.load(fileName), false);
+    QCOMPARE(catalog.errorString(), QString("Snapshot checksum mismatch"));
+    QCOMPARE(catalog.isEmpty(), true);
+
+    QFile::remove(fileName);
+    QCOMPARE(catalog.load(fileName), false);
+    QCOMPARE(catalog.errorString().isEmpty(), false);
+}
+
+void TestSmoozikTrackCatalog::indexOf()
+{
+    SmoozikPlaylist playlist;
+    playlist.addTrack("a", "track1");
+    playlist.addTrack("b", "track2");
+    playlist.addTrack("c", "track3");
+
+    SmoozikTrackCatalog catalog;
+    QCOMPARE(catalog.indexOf("a"), -1);
+    QCOMPARE(catalog.load(&playlist), true);
+    QCOMPARE(catalog.indexOf("a"), 0);
+    QCOMPARE(catalog.indexOf("c"), 2);
+    QCOMPARE(catalog.indexOf("d"), -1);
+
+    // Index is rebuilt for a new catalog
+    playlist.removeFirst();
+    QCOMPARE(catalog.load(&playlist), true);
+    QCOMPARE(catalog.indexOf("a"), -1);
+    QCOMPARE(catalog.indexOf("c"), 1);
+}
+
+QTEST_XML_MAIN(TestSmoozikTrackCatalog)
@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmooziktrackdata.h
+
+SOURCES += \
+    testsmooziktrackdata.cpp
@@ -0,0 +1,105 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmooziktrackdata.h"
+#include "smooziktrackdata.h"
+#include "smooziktrack.h"
+#include "smoozikxml.h"
+
+void TestSmoozikTrackData::constructors()
+{
+    SmoozikTrackData track;
+    QCOMPARE(track.isNull(), true);
+    QCOMPARE(track.localId(), QString());
+    QCOMPARE(track.duration(), (uint)0);
+
+    SmoozikTrackData track2("id", "track", "artist", "album", 220, "fileName");
+    QCOMPARE(track2.isNull(), false);
+    QCOMPARE(track2.localId(), QString("id"));
+    QCOMPARE(track2.name(), QString("track"));
+    QCOMPARE(track2.artist(), QString("artist"));
+    QCOMPARE(track2.album(), QString("album"));
+    QCOMPARE(track2.duration(), (uint)220);
+    QCOMPARE(track2.fileName(), QString("fileName"));
+
+    SmoozikTrack track3(track2);
+    QCOMPARE(track3.data(), track2);
+    QCOMPARE(track3.localId(), QString("id"));
+    QCOMPARE(track3.fileName(), QString("fileName"));
+}
+
+void TestSmoozikTrackData::fromMap()
+{
+    QDomDocument doc;
+    doc.setContent(QString("<track><localId>id</localId><name>track</name><album>album</album><artist>artist</artist><duration>220</duration></track>"));
+    QVariantMap map = SmoozikXml::parseElement(doc.firstChildElement()).toMap();
+
+    SmoozikTrackData track = SmoozikTrackData::fromMap(map);
+    QCOMPARE(track.localId(), QString("id"));
+    QCOMPARE(track.name(), QString("track"));
+    QCOMPARE(track.artist(), QString("artist"));
+    QCOMPARE(track.album(), QString("album"));
+    QCOMPARE(track.duration(), (uint)220);
+    QCOMPARE(track.fileName(), QString());
+
+    SmoozikTrack object(map);
+    QCOMPARE(object.data(), track);
+
+    QCOMPARE(SmoozikTrackData::fromMap(QVariantMap()).isNull(), true);
+}
+
+void TestSmoozikTrackData::sharing()
+{
+    SmoozikTrackData track("id", "track");
+    SmoozikTrackData copy = track;
+    QCOMPARE(copy.localId(), QString("id"));
+
+    // Copies detach on write
+    copy.setName("renamed");
+    copy.setDuration(12);
+    QCOMPARE(track.name(), QString("track"));
+    QCOMPARE(track.duration(), (uint)0);
+    QCOMPARE(copy.name(), QString("renamed"));
+    QCOMPARE(copy.duration(), (uint)12);
+
+    QVariant variant = QVariant::fromValue(track);
+    QCOMPARE(variant.value<SmoozikTrackData>(), track);
+
+    QList<SmoozikTrackData> list;
+    list << track << copy;
+    QCOMPARE(list.at(1).name(), QString("renamed"));
+}
+
+void TestSmoozikTrackData::equality()
+{
+    SmoozikTrackData track("id", "track", "artist");
+    SmoozikTrackData same("id", "track", "artist");
+    SmoozikTrackData other("id", "track");
+
+    QVERIFY(track == track);
+    QVERIFY(track == same);
+    QVERIFY(track != other);
+    other.setArtist("artist");
+    QVERIFY(track == other);
+    other.setFileName("fileName");
+    QVERIFY(track != other);
+}
+
+QTEST_XML_MAIN(TestSmoozikTrackData)
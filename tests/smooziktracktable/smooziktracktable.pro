@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmooziktracktable.h
+
+SOURCES += \
+    testsmooziktracktable.cpp
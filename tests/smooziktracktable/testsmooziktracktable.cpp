@@ -0,0 +1,129 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmooziktracktable.h"
+#include "smooziktracktable.h"
+#include "smoozikplaylist.h"
+
+void TestSmoozikTrackTable::append()
+{
+    SmoozikTrackTable table;
+    QCOMPARE(table.isEmpty(), true);
+    QCOMPARE(table.count(), 0);
+
+    table.append("1", "track1", "artist1", "album1", 220, "file1");
+    table.append(SmoozikTrackData("2", "track2", "artist1", QString(), 180));
+    table.append("3", "track3");
+    QCOMPARE(table.isEmpty(), false);
+    QCOMPARE(table.count(), 3);
+
+    QCOMPARE(table.localId(0).toString(), QString("1"));
+    QCOMPARE(table.name(0).toString(), QString("track1"));
+    QCOMPARE(table.artist(0).toString(), QString("artist1"));
+    QCOMPARE(table.album(0).toString(), QString("album1"));
+    QCOMPARE(table.duration(0), (uint)220);
+    QCOMPARE(table.fileName(0).toString(), QString("file1"));
+    QCOMPARE(table.value(1, SmoozikTrackTable::Name).toString(), QString("track2"));
+    QCOMPARE(table.album(1).isNull(), true);
+    QCOMPARE(table.artist(2).isNull(), true);
+    QCOMPARE(table.duration(2), (uint)0);
+
+    // Interned columns share ids
+    QCOMPARE(table.stringId(0, SmoozikTrackTable::Artist), table.stringId(1, SmoozikTrackTable::Artist));
+    QCOMPARE(table.stringId(1, SmoozikTrackTable::Album), 0);
+    QCOMPARE(table.internedId("artist1"), table.stringId(0, SmoozikTrackTable::Artist));
+    QCOMPARE(table.internedId("track1"), -1);
+    QCOMPARE(table.stringIds(SmoozikTrackTable::Artist)[1], table.stringId(1, SmoozikTrackTable::Artist));
+    QCOMPARE(table.durations()[1], (uint)180);
+    QCOMPARE(table.totalDuration(), (quint64)400);
+}
+
+void TestSmoozikTrackTable::find()
+{
+    SmoozikTrackTable table;
+    table.append("1", "track1", "artist1", "album1", 220, "file1");
+    table.append("2", "track2", "artist2", "album1", 180);
+    table.append("3", "track3", "artist1");
+    table.append("4", "track1", "artist12");
+
+    QCOMPARE(table.find(SmoozikTrackTable::Artist, "artist1"), QVector<int>() << 0 << 2);
+    QCOMPARE(table.find(SmoozikTrackTable::Artist, "artist"), QVector<int>());
+    QCOMPARE(table.find(SmoozikTrackTable::Album, "album1"), QVector<int>() << 0 << 1);
+    QCOMPARE(table.find(SmoozikTrackTable::Album, QString()), QVector<int>() << 2 << 3);
+    QCOMPARE(table.find(SmoozikTrackTable::Name, "track1"), QVector<int>() << 0 << 3);
+    QCOMPARE(table.find(SmoozikTrackTable::LocalId, "3"), QVector<int>() << 2);
+    QCOMPARE(table.find(SmoozikTrackTable::LocalId, "5"), QVector<int>());
+    QCOMPARE(table.find(SmoozikTrackTable::FileName, "file1"), QVector<int>() << 0);
+    QCOMPARE(table.find(SmoozikTrackTable::FileName, QString()), QVector<int>() << 1 << 2 << 3);
+}
+
+void TestSmoozikTrackTable::conversion()
+{
+    SmoozikPlaylist playlist;
+    playlist.addTrack("1", "track1", "artist1", "album1", 220, "file1");
+    playlist.addTrack("2", "track2", "artist2");
+
+    SmoozikTrackTable table(&playlist);
+    QCOMPARE(table.count(), 2);
+    QCOMPARE(table.trackData(0), playlist.trackData(0));
+    QCOMPARE(table.trackData(1), playlist.trackData(1));
+    // No track object is created to fill the table
+    QCOMPARE(playlist.children().count(), 0);
+
+    table.append("1", "duplicate");
+    SmoozikPlaylist *copy = table.toPlaylist(this);
+    QCOMPARE(copy->parent(), (QObject *)this);
+    QCOMPARE(copy->count(), 2);
+    QCOMPARE(copy->trackData(0), playlist.trackData(0));
+    QCOMPARE(copy->trackData(1), playlist.trackData(1));
+    delete copy;
+}
+
+void TestSmoozikTrackTable::clear()
+{
+    SmoozikTrackTable table;
+    table.append("1", "track1", "artist1");
+    table.clear();
+    QCOMPARE(table.isEmpty(), true);
+    QCOMPARE(table.internedId("artist1"), -1);
+    QCOMPARE(table.totalDuration(), (quint64)0);
+
+    table.append("2", "track2", "artist2");
+    QCOMPARE(table.count(), 1);
+    QCOMPARE(table.artist(0).toString(), QString("artist2"));
+    QCOMPARE(table.find(SmoozikTrackTable::Artist, "artist2"), QVector<int>() << 0);
+}
+
+void TestSmoozikTrackTable::scanBenchmark()
+{
+    const int trackCount = 300000;
+    SmoozikTrackTable table;
+    table.reserve(trackCount);
+    for (int i = 0; i < trackCount; i++) {
+        table.append(QString::number(i), QString("track%1").arg(i), QString("artist%1").arg(i % 1000), QString("album%1").arg(i % 3000), 180 + i % 120);
+    }
+
+    QBENCHMARK {
+        QCOMPARE(table.find(SmoozikTrackTable::Artist, "artist42").size(), trackCount / 1000);
+        QVERIFY(table.totalDuration() > 0);
+    }
+}
+
+QTEST_XML_MAIN(TestSmoozikTrackTable)
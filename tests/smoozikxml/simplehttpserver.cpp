@@ -1,71 +0,0 @@
-/*
-   Copyright 2013 Noviware SARL.
-      - Primarily authored by Fabien Pierre-Nicolas
-
-   This file is part of libsmoozk-qt.
-
-   libsmoozk-qt is free software: you can redistribute it and/or modify
-   it under the terms of the GNU General Public License as published by
-   the Free Software Foundation, either version 3 of the License, or
-   (at your option) any later version.
-
-   libsmoozk-qt is distributed in the hope that it will be useful,
-   but WITHOUT ANY WARRANTY; without even the implied warranty of
-   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-   GNU General Public License for more details.
-
-   You should have received a copy of the GNU General Public License
-   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#include "simplehttpserver.h"
-
-#include <QStringList>
-
-SimpleHttpServer::SimpleHttpServer(quint16 port, QObject* parent) :
-    QTcpServer(parent)
-{
-    listen(QHostAddress("127.0.0.1"), port);
-}
-
-void SimpleHttpServer::incomingConnection(int socket)
-{
-    // When a new client connects, the server constructs a QTcpSocket and all
-    // communication with the client is done over this QTcpSocket. QTcpSocket
-    // works asynchronously, this means that all the communication is done
-    // in the two slots readClient() and discardClient().
-    QTcpSocket* s = new QTcpSocket(this);
-    connect(s, SIGNAL(readyRead()), this, SLOT(readClient()));
-    connect(s, SIGNAL(disconnected()), this, SLOT(discardClient()));
-    s->setSocketDescriptor(socket);
-}
-
-void SimpleHttpServer::readClient()
-{
-    // This slot is called when the client sent data to the server. The
-    // server looks if it was a get request and sends a very simple HTML
-    // document back.
-    QTcpSocket* socket = (QTcpSocket*) sender();
-    if (socket->canReadLine()) {
-        QStringList tokens = QString(socket->readLine()).split(QRegExp("[ \r\n][ \r\n]*"));
-        if (tokens[0] == "GET") {
-            QTextStream os(socket);
-            os.setAutoDetectUnicode(true);
-            os << "HTTP/1.0 200 Ok\r\n"
-               "Content-Type: text/html; charset=\"utf-8\"\r\n"
-               "\r\n"
-               << response() << "\n";
-            socket->close();
-
-            if (socket->state() == QTcpSocket::UnconnectedState) {
-                delete socket;
-            }
-        }
-    }
-}
-
-void SimpleHttpServer::discardClient()
-{
-    QTcpSocket* socket = (QTcpSocket*) sender();
-    socket->deleteLater();
-}
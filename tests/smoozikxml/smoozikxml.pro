@@ -2,8 +2,8 @@ include(../tests.pri)
 
 HEADERS += \
     testsmoozikxml.h \
-    simplehttpserver.h
+    ../simplehttpserver.h
 
 SOURCES += \
     testsmoozikxml.cpp \
-    simplehttpserver.cpp
+    ../simplehttpserver.cpp
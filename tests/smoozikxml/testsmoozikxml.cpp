@@ -21,6 +21,42 @@
 #include "testsmoozikxml.h"
 #include "smoozikxml.h"
 #include "simplehttpserver.h"
+#include <QBuffer>
+
+/**
+ * @brief Reference implementation of SmoozikXml::printVariant() building its string by concatenation.
+ */
+static QString legacyPrintVariant(const QVariant &variant, const int indentCount = 0)
+{
+    QString res;
+    QString tab = "    ";
+    QString indent;
+    for (int i = 0; i < indentCount; i++) {
+        indent += tab;
+    }
+
+    if (!variant.toString().isEmpty()) {
+        res = variant.toString() + "\n";
+    } else if (!variant.toList().isEmpty()) {
+        res += "{\n";
+
+        foreach(QVariant child, variant.toList()) {
+            res += indent + tab + legacyPrintVariant(child, indentCount + 1);
+        }
+        res += indent + "}\n";
+    } else if (!variant.toMap().isEmpty()) {
+        res += "{\n";
+
+        foreach(QString key, variant.toMap().keys()) {
+            res += indent + tab + key + " : " + legacyPrintVariant(variant.toMap()[key], indentCount + 1);
+        }
+        res += indent + "}\n";
+    } else {
+        res = "\n";
+    }
+
+    return res;
+}
 
 void TestSmoozikXml::serverUnreachable()
 {
@@ -122,4 +158,322 @@ void TestSmoozikXml::operators()
     QCOMPARE(xml.parsedString(), toString);
 }
 
+void TestSmoozikXml::value_data()
+{
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<QString>("result");
+    QTest::addColumn<bool>("isNull");
+
+    QTest::newRow("Key") << "code" << "ABCD" << false;
+    QTest::newRow("Nested key") << "party/code" << "1234" << false;
+    QTest::newRow("Index") << "tracks/1/track/name" << "track2" << false;
+    QTest::newRow("Extra slashes") << "/party//code/" << "1234" << false;
+    QTest::newRow("Missing key") << "party/name" << QString() << true;
+    QTest::newRow("Index out of range") << "tracks/3/track/name" << QString() << true;
+    QTest::newRow("Index in a map") << "party/0" << QString() << true;
+    QTest::newRow("Key of a string") << "code/a" << QString() << true;
+}
+
+void TestSmoozikXml::value()
+{
+    QFETCH(QString, path);
+    QFETCH(QString, result);
+    QFETCH(bool, isNull);
+
+    SmoozikXml xml;
+    xml.addData("<smoozik><status>ok</status><data><code>ABCD</code><party><code>1234</code></party>"
+                "<tracks><track><name>track1</name></track><track><name>track2</name></track><track><name>track3</name></track></tracks>"
+                "</data></smoozik>");
+    QCOMPARE(xml.finish(), true);
+
+    QCOMPARE(xml.value(path).toString(), result);
+    QCOMPARE(xml.value(path).isNull(), isNull);
+
+    // Indexed paths return the same element
+    QCOMPARE(&xml.value(path), &xml.value(path));
+    QCOMPARE(xml.value("tracks/1/track/name"), xml["tracks"].toList().value(1).toMap()["track"].toMap()["name"]);
+    QCOMPARE(xml.value("code"), xml["code"]);
+
+    // Index is cleared with the response
+    xml.addData("<smoozik><status>ok</status><data><code>EFGH</code></data></smoozik>");
+    QCOMPARE(xml.finish(), true);
+    QCOMPARE(xml.value("code").toString(), QString("EFGH"));
+    QCOMPARE(xml.value("party/code").isNull(), true);
+}
+
+void TestSmoozikXml::incremental_data()
+{
+    QTest::addColumn<QString>("data");
+
+    QTest::newRow("Text") << "hello";
+    QTest::newRow("Entities") << "Simon &amp; Garfunkel";
+    QTest::newRow("Map") << "<party><id>1</id><name>Party</name></party>";
+    QTest::newRow("Repeated tags") << "<track><id>1</id></track><track><id>2</id></track><count>2</count>";
+    QTest::newRow("Plural tag") << "<tracks><track><id>1</id><name>Track</name></track></tracks>";
+    QTest::newRow("Empty plural tag") << "<tracks></tracks><s></s>";
+    QTest::newRow("Mixed content") << "<a>text<b>ignored</b>tail</a><c><d>1</d>text</c>";
+    QTest::newRow("Whitespace") << "\n  <a>\n    <b> spaced </b>\n  </a>\n";
+    QTest::newRow("CDATA") << "<a><![CDATA[<raw>]]></a><b>x<![CDATA[y]]></b>";
+    QTest::newRow("Comment") << "<a><!-- comment -->text</a><b><c>1</c><!-- comment --></b>";
+    QTest::newRow("Duplicated keys") << "<a>1</a><b>2</b><a>3</a>";
+}
+
+void TestSmoozikXml::incremental()
+{
+    QFETCH(QString, data);
+
+    QByteArray response = QString("<smoozik><status>ok</status><data>%1</data></smoozik>").arg(data).toUtf8();
+
+    // Reference is the Dom parser
+    QDomDocument document;
+    QCOMPARE(document.setContent(response), true);
+    SmoozikXml domXml;
+    domXml.parse(document.firstChildElement("smoozik").firstChildElement("data"));
+
+    // Data is given byte per byte
+    SmoozikXml xml;
+    for (int i = 0; i < response.size(); i++) {
+        xml.addData(response.mid(i, 1));
+    }
+    QCOMPARE(xml.finish(), true);
+    QCOMPARE(xml.print(), domXml.print());
+    QCOMPARE(xml.parsedString(), domXml.parsedString());
+    QCOMPARE(xml["a"], domXml["a"]);
+    QCOMPARE(xml[0], domXml[0]);
+}
+
+void TestSmoozikXml::startParse()
+{
+    SimpleHttpServer server(8181);
+    server.setResponse("<smoozik><status>ok</status><data><party><id>1</id></party></data></smoozik>");
+
+    QNetworkAccessManager manager;
+    QNetworkReply *reply = manager.get(QNetworkRequest(QUrl("http://127.0.0.1:8181")));
+    QPointer<QNetworkReply> guard(reply);
+
+    SmoozikXml xml;
+    QSignalSpy parseFinishedSpy(&xml, SIGNAL(parseFinished(bool)));
+    xml.startParse(reply);
+
+    for (int i = 0; i < 100 && parseFinishedSpy.isEmpty(); i++) {
+        QTest::qWait(50);
+    }
+    QCOMPARE(parseFinishedSpy.count(), 1);
+    QCOMPARE(parseFinishedSpy.first().first().toBool(), true);
+    QCOMPARE(xml["party"].toMap()["id"].toString(), QString("1"));
+
+    // Reply is deleted once parsed
+    QTest::qWait(0);
+    QCOMPARE(guard.isNull(), true);
+
+    // Failed responses are detected before the end of the response
+    xml.addData("<smoozik><status>failed</status><error><code>3</code><message>Authentication Failed</message></error><data><unclosed>");
+    QCOMPARE(xml.finish(), false);
+    QCOMPARE(xml.error(), SmoozikManager::AuthenticationFailed);
+    QCOMPARE(xml.errorMsg(), QString("Authentication Failed"));
+}
+
+void TestSmoozikXml::lazy_data()
+{
+    QTest::addColumn<QString>("response");
+    QTest::addColumn<bool>("parseResult");
+    QTest::addColumn<int>("error");
+
+    QTest::newRow("Success") << "<smoozik><status>ok</status><data><party><id>1</id><name>Party</name></party><tracks><track><id>1</id></track></tracks></data></smoozik>" << true << (int) SmoozikManager::NoError;
+    QTest::newRow("Status after data") << "<smoozik><data><party><id>1</id></party></data><status>ok</status></smoozik>" << true << (int) SmoozikManager::NoError;
+    QTest::newRow("Text data") << "<smoozik><status>ok</status><data>hello</data></smoozik>" << true << (int) SmoozikManager::NoError;
+    QTest::newRow("Failed") << "<smoozik><status>failed</status><error><code>3</code><message>Authentication Failed</message></error><data><a>1</a></data></smoozik>" << false << (int) SmoozikManager::AuthenticationFailed;
+    QTest::newRow("Failed after data") << "<smoozik><data><a>1</a></data><status>failed</status><error><code>3</code><message>Authentication Failed</message></error></smoozik>" << false << (int) SmoozikManager::AuthenticationFailed;
+    QTest::newRow("Malformed data after status") << "<smoozik><status>ok</status><data><a>1</b></data></smoozik>" << true << (int) SmoozikManager::ParseError;
+    QTest::newRow("Malformed data before status") << "<smoozik><data><a>1</b></data><status>ok</status></smoozik>" << false << (int) SmoozikManager::ParseError;
+    QTest::newRow("No data") << "<smoozik><status>ok</status></smoozik>" << false << (int) SmoozikManager::ParseError;
+}
+
+void TestSmoozikXml::lazy()
+{
+    QFETCH(QString, response);
+    QFETCH(bool, parseResult);
+    QFETCH(int, error);
+
+    QByteArray data = response.toUtf8();
+
+    SmoozikXml eager;
+    eager.addData(data);
+    bool eagerResult = eager.finish();
+
+    // Response is given in small chunks, as it would arrive from the network
+    SmoozikXml xml;
+    QCOMPARE(xml.isLazy(), false);
+    xml.setLazy(true);
+    QCOMPARE(xml.isLazy(), true);
+    for (int i = 0; i < data.size(); i += 7) {
+        xml.addData(data.mid(i, 7));
+    }
+    QCOMPARE(xml.finish(), parseResult);
+
+    if (parseResult) {
+        // Data is decoded on first access
+        QCOMPARE(xml.error(), SmoozikManager::NoError);
+        QCOMPARE(xml.print(), eager.print());
+        QCOMPARE((int) xml.error(), error);
+        QCOMPARE(xml["party"], eager["party"]);
+        QCOMPARE(xml.value("party/id"), eager.value("party/id"));
+        QCOMPARE(xml.parsedString(), eager.parsedString());
+    } else {
+        QCOMPARE(eagerResult, false);
+        QCOMPARE((int) xml.error(), error);
+        QCOMPARE(xml.error(), eager.error());
+        QCOMPARE(xml.print(), QString("\n"));
+    }
+
+    // Next response is parsed from scratch
+    xml.addData("<smoozik><status>ok</status><data><code>ABCD</code></data></smoozik>");
+    QCOMPARE(xml.finish(), true);
+    QCOMPARE(xml["code"].toString(), QString("ABCD"));
+    QCOMPARE(xml.error(), SmoozikManager::NoError);
+}
+
+void TestSmoozikXml::reuse()
+{
+    QStringList responses;
+    responses << "<smoozik><status>ok</status><data><tracks><track><localId>1</localId><name>a</name></track><track><localId>2</localId></track></tracks></data></smoozik>"
+              << "<smoozik><status>ok</status><data>hello</data></smoozik>"
+              << "<smoozik><status>ok</status><data><a><b><c><d>deep</d></c></b></a></data>"
+              << "<smoozik><status>ok</status><data><a>1</a><b>2</b></data></smoozik>"
+              << "<smoozik><status>failed</status><error><code>3</code><message>Authentication Failed</message></error></smoozik>"
+              << "<smoozik><status>ok</status><data><party><id>1</id></party></data></smoozik>";
+
+    // A parser reused for successive responses gives the same results as new parsers
+    SmoozikXml reused;
+    for (int round = 0; round < 2; round++) {
+        foreach(const QString & response, responses) {
+            SmoozikXml xml;
+            xml.addData(response.toUtf8());
+            bool result = xml.finish();
+
+            reused.addData(response.toUtf8());
+            QCOMPARE(reused.finish(), result);
+            QCOMPARE(reused.error(), xml.error());
+            QCOMPARE(reused.errorMsg(), xml.errorMsg());
+            QCOMPARE(reused.print(), xml.print());
+        }
+    }
+
+    reused.clear();
+    QCOMPARE(reused.print(), QString("\n"));
+    QCOMPARE(reused.error(), SmoozikManager::NoError);
+}
+
+void TestSmoozikXml::printStream_data()
+{
+    QTest::addColumn<QString>("data");
+
+    QTest::newRow("Text") << "hello";
+    QTest::newRow("Empty") << "";
+    QTest::newRow("Map") << "<party><id>1</id><name>Party</name><empty></empty></party>";
+    QTest::newRow("List") << "<tracks><track><id>1</id><name>Track</name></track><track><id>2</id></track></tracks>";
+    QTest::newRow("Empty list") << "<tracks></tracks><s></s>";
+    QTest::newRow("Nested") << "<a><b><c><d>deep</d></c></b></a><e>Simon &amp; Garfunkel</e>";
+}
+
+void TestSmoozikXml::printStream()
+{
+    QFETCH(QString, data);
+
+    SmoozikXml xml;
+    xml.addData(QString("<smoozik><status>ok</status><data>%1</data></smoozik>").arg(data).toUtf8());
+    QCOMPARE(xml.finish(), true);
+
+    QDomDocument doc;
+    QVERIFY(doc.setContent(QString("<data>%1</data>").arg(data)));
+    QVariant variant = SmoozikXml::parseElement(doc.documentElement());
+    QString expected = legacyPrintVariant(variant);
+    QCOMPARE(SmoozikXml::printVariant(variant), expected);
+    QCOMPARE(SmoozikXml::printVariant(variant, 2), legacyPrintVariant(variant, 2));
+    QCOMPARE(SmoozikXml::printVariant(QVariant()), legacyPrintVariant(QVariant()));
+    QCOMPARE(xml.print(), expected);
+
+    QString streamed;
+    QTextStream stream(&streamed);
+    xml.print(stream);
+    stream.flush();
+    QCOMPARE(streamed, expected);
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    xml.print(&buffer);
+    QCOMPARE(QString::fromUtf8(buffer.data()), expected);
+}
+
+void TestSmoozikXml::printJsonLine()
+{
+    QString line;
+    QTextStream stream(&line);
+
+    SmoozikXml xml;
+    xml.addData(QString::fromUtf8("<smoozik><status>ok</status><data><party><name>Caf\xc3\xa9 \"Bar\" \\ 1&#9;2</name><id>1</id></party>"
+                                  "<tracks><track><id>1</id></track><track><id>2</id></track></tracks><empty></empty></data></smoozik>").toUtf8());
+    QCOMPARE(xml.finish(), true);
+    xml.printJsonLine(stream);
+    stream.flush();
+    QCOMPARE(line, QString::fromUtf8("{\"error\":0,\"data\":{\"empty\":{},\"party\":{\"id\":\"1\",\"name\":\"Caf\xc3\xa9 \\\"Bar\\\" \\\\ 1\\t2\"},"
+                                     "\"tracks\":[{\"track\":{\"id\":\"1\"}},{\"track\":{\"id\":\"2\"}}]}}\n"));
+
+    line.clear();
+    xml.addData("<smoozik><status>failed</status><error><code>3</code><message>Authentication \"Failed\"</message></error></smoozik>");
+    QCOMPARE(xml.finish(), false);
+    xml.printJsonLine(stream);
+    stream.flush();
+    QCOMPARE(line, QString("{\"error\":3,\"errorMsg\":\"Authentication \\\"Failed\\\"\"}\n"));
+
+    line.clear();
+    SmoozikXml::printJson(stream, QVariant());
+    SmoozikXml::printJson(stream, QString(QChar(1)) + "\n");
+    stream.flush();
+    QCOMPARE(line, QString("null\"\\u0001\\n\""));
+}
+
+void TestSmoozikXml::printBenchmark_data()
+{
+    QTest::addColumn<bool>("legacy");
+
+    QTest::newRow("Legacy") << true;
+    QTest::newRow("Stream") << false;
+}
+
+void TestSmoozikXml::printBenchmark()
+{
+    QFETCH(bool, legacy);
+
+    // getTopTracks response with 500 tracks
+    QByteArray data = "<smoozik><status>ok</status><data><tracks>";
+    for (int i = 0; i < 500; i++) {
+        data += QString("<track><localId>%1</localId><name>Track %1</name><artist>Artist %2</artist><album>Album %2</album><duration>%3</duration></track>")
+                .arg(i).arg(i / 10).arg(180 + i).toUtf8();
+    }
+    data += "</tracks></data></smoozik>";
+
+    SmoozikXml xml;
+    xml.addData(data);
+    QCOMPARE(xml.finish(), true);
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    if (legacy) {
+        QBENCHMARK {
+            buffer.seek(0);
+            buffer.write(legacyPrintVariant(xml["tracks"]).toUtf8());
+        }
+    } else {
+        QTextStream stream(&buffer);
+        stream.setCodec("UTF-8");
+        QBENCHMARK {
+            stream.seek(0);
+            SmoozikXml::printVariant(stream, xml["tracks"]);
+            stream.flush();
+        }
+    }
+    QCOMPARE(QString::fromUtf8(buffer.data()).startsWith("{\n    {\n        track : {\n"), true);
+}
+
 QTEST_XML_MAIN(TestSmoozikXml)
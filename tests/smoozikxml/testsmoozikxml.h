@@ -33,6 +33,19 @@ private slots:
     void parse();
     void operators_data();
     void operators();
+    void value_data();
+    void value();
+    void incremental_data();
+    void incremental();
+    void startParse();
+    void lazy_data();
+    void lazy();
+    void reuse();
+    void printStream_data();
+    void printStream();
+    void printJsonLine();
+    void printBenchmark_data();
+    void printBenchmark();
 };
 
 #endif // TESTSMOOZIKXML_H
@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmoozikxmlpool.h
+
+SOURCES += \
+    testsmoozikxmlpool.cpp
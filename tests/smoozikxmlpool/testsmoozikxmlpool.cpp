@@ -0,0 +1,143 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmoozikxmlpool.h"
+#include "smoozikxmlpool.h"
+
+void ParserThread::run()
+{
+    for (int i = 0; i < 200; i++) {
+        SmoozikXml *xml = _pool->acquire();
+        if (xml->thread() != QThread::currentThread()) {
+            _failures++;
+        }
+
+        QString code = QString("%1-%2").arg(_id).arg(i);
+        xml->setLazy(i % 2);
+        xml->addData(QString("<smoozik><status>ok</status><data><party><code>%1</code></party></data></smoozik>").arg(code).toUtf8());
+        if (!xml->finish() || xml->value("party/code").toString() != code) {
+            _failures++;
+        }
+        _pool->release(xml);
+    }
+}
+
+void TestSmoozikXmlPool::acquireRelease()
+{
+    SmoozikXmlPool pool;
+    QCOMPARE(pool.idleCount(), 0);
+    QCOMPARE(pool.maxIdleCount(), 4);
+
+    SmoozikXml *xml = pool.acquire();
+    QVERIFY(xml != 0);
+    QCOMPARE(xml->thread(), QThread::currentThread());
+    xml->setLazy(true);
+    xml->addData("<smoozik><status>ok</status><data><code>ABCD</code></data></smoozik>");
+    QCOMPARE(xml->finish(), true);
+
+    pool.release(xml);
+    QCOMPARE(pool.idleCount(), 1);
+
+    // Parser is reused, without state of its previous response
+    SmoozikXml *xml2 = pool.acquire();
+    QCOMPARE(xml2, xml);
+    QCOMPARE(pool.idleCount(), 0);
+    QCOMPARE(xml2->thread(), QThread::currentThread());
+    QCOMPARE(xml2->isLazy(), false);
+    QCOMPARE(xml2->error(), SmoozikManager::NoError);
+    QCOMPARE(xml2->value("code").isNull(), true);
+
+    SmoozikXml *xml3 = pool.acquire();
+    QVERIFY(xml3 != xml2);
+    pool.release(xml2);
+    pool.release(xml3);
+    pool.release(0);
+    QCOMPARE(pool.idleCount(), 2);
+}
+
+void TestSmoozikXmlPool::maxIdleCount()
+{
+    SmoozikXmlPool pool(2);
+    QCOMPARE(pool.maxIdleCount(), 2);
+
+    QList<SmoozikXml *> parsers;
+    for (int i = 0; i < 4; i++) {
+        parsers.append(pool.acquire());
+    }
+    QPointer<SmoozikXml> guard(parsers.last());
+    foreach(SmoozikXml * xml, parsers) {
+        pool.release(xml);
+    }
+
+    // Parsers in excess are deleted
+    QCOMPARE(pool.idleCount(), 2);
+    QCOMPARE(guard.isNull(), true);
+
+    pool.setMaxIdleCount(1);
+    QCOMPARE(pool.maxIdleCount(), 1);
+    QCOMPARE(pool.idleCount(), 1);
+
+    pool.setMaxIdleCount(0);
+    QCOMPARE(pool.idleCount(), 0);
+    pool.release(pool.acquire());
+    QCOMPARE(pool.idleCount(), 0);
+}
+
+void TestSmoozikXmlPool::threads()
+{
+    SmoozikXmlPool pool(2);
+
+    QList<ParserThread *> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.append(new ParserThread(&pool, i));
+    }
+    foreach(ParserThread * thread, threads) {
+        thread->start();
+    }
+    foreach(ParserThread * thread, threads) {
+        QVERIFY(thread->wait(30000));
+        QCOMPARE(thread->failures(), 0);
+    }
+    qDeleteAll(threads);
+
+    QVERIFY(pool.idleCount() <= 2);
+    QVERIFY(pool.idleCount() > 0);
+
+    // Idle parsers can be used by the main thread again
+    SmoozikXml *xml = pool.acquire();
+    QCOMPARE(xml->thread(), QThread::currentThread());
+    xml->addData("<smoozik><status>ok</status><data><code>ABCD</code></data></smoozik>");
+    QCOMPARE(xml->finish(), true);
+    QCOMPARE(xml->value("code").toString(), QString("ABCD"));
+    pool.release(xml);
+}
+
+void TestSmoozikXmlPool::globalInstance()
+{
+    SmoozikXmlPool *pool = SmoozikXmlPool::globalInstance();
+    QVERIFY(pool != 0);
+    QCOMPARE(SmoozikXmlPool::globalInstance(), pool);
+
+    SmoozikXml *xml = pool->acquire();
+    QVERIFY(xml != 0);
+    pool->release(xml);
+}
+
+QTEST_XML_MAIN(TestSmoozikXmlPool)
@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+HEADERS += \
+    testsmoozikxmltree.h
+
+SOURCES += \
+    testsmoozikxmltree.cpp
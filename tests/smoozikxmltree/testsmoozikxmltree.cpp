@@ -0,0 +1,216 @@
+/*
+   Copyright 2013 Noviware SARL.
+      - Primarily authored by Fabien Pierre-Nicolas
+
+   This file is part of libsmoozk-qt.
+
+   libsmoozk-qt is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libsmoozk-qt is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with libsmoozk-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testsmoozikxmltree.h"
+#include "smoozikxmltree.h"
+#include "smoozikxml.h"
+
+void TestSmoozikXmlTree::toVariant_data()
+{
+    QTest::addColumn<QString>("data");
+
+    QTest::newRow("Text") << "hello";
+    QTest::newRow("Entities") << "Simon &amp; Garfunkel";
+    QTest::newRow("Map") << "<party><id>1</id><name>Party</name></party>";
+    QTest::newRow("Repeated tags") << "<track><id>1</id></track><track><id>2</id></track><count>2</count>";
+    QTest::newRow("Plural tag") << "<tracks><track><id>1</id><name>Track</name></track></tracks>";
+    QTest::newRow("Empty plural tag") << "<tracks></tracks><s></s>";
+    QTest::newRow("Mixed content") << "<a>text<b>ignored</b>tail</a><c><d>1</d>text</c>";
+    QTest::newRow("Whitespace") << "\n  <a>\n    <b> spaced </b>\n  </a>\n";
+    QTest::newRow("CDATA") << "<a><![CDATA[<raw>]]></a><b>x<![CDATA[y]]></b>";
+    QTest::newRow("Comment") << "<a><!-- comment -->text</a><b><c>1</c><!-- comment --></b>";
+    QTest::newRow("Duplicated keys") << "<a>1</a><b>2</b><a>3</a>";
+    QTest::newRow("Unicode") << QString::fromUtf8("<name>Beyonc\xc3\xa9</name><artist>\xe6\x97\xa5\xe6\x9c\xac</artist>");
+}
+
+void TestSmoozikXmlTree::toVariant()
+{
+    QFETCH(QString, data);
+
+    QByteArray xml = QString("<smoozik><status>ok</status><data>%1</data></smoozik>").arg(data).toUtf8();
+
+    QDomDocument doc;
+    QVERIFY(doc.setContent(xml));
+    QVariant expected = SmoozikXml::parseElement(doc.documentElement());
+
+    SmoozikXmlTree tree;
+    QCOMPARE(tree.parse(xml), true);
+    QCOMPARE(tree.errorString(), QString());
+    QCOMPARE(SmoozikXml::printVariant(tree.toVariant()), SmoozikXml::printVariant(expected));
+    QCOMPARE(tree.toVariant(), expected);
+
+    int dataNode = tree.child(tree.root(), "data");
+    QVERIFY(dataNode > 0);
+    QCOMPARE(tree.toVariant(dataNode), SmoozikXml::parseElement(doc.documentElement().firstChildElement("data")));
+}
+
+void TestSmoozikXmlTree::navigation()
+{
+    SmoozikXmlTree tree;
+    QCOMPARE(tree.isEmpty(), true);
+    QCOMPARE(tree.root(), -1);
+    QCOMPARE(tree.toVariant(), QVariant());
+
+    QCOMPARE(tree.parse("<smoozik><status>ok</status><data><tracks>"
+                        "<track><localId>1</localId><name>track1</name></track>"
+                        "<track><localId>2</localId><name>track2</name></track>"
+                        "</tracks></data></smoozik>"), true);
+    QCOMPARE(tree.count(), 10);
+
+    int root = tree.root();
+    QCOMPARE(tree.name(root), QString("smoozik"));
+    QCOMPARE(tree.parent(root), -1);
+    QCOMPARE(tree.childCount(root), 2);
+    QCOMPARE(tree.isText(root), false);
+    QCOMPARE(tree.text(root).isNull(), true);
+
+    int status = tree.firstChild(root);
+    QCOMPARE(tree.name(status), QString("status"));
+    QCOMPARE(tree.isText(status), true);
+    QCOMPARE(tree.text(status).toString(), QString("ok"));
+    QCOMPARE(tree.child(root, "status"), status);
+    QCOMPARE(tree.child(root, "error"), -1);
+    QCOMPARE(tree.child(root, "neverInternedName"), -1);
+
+    int tracks = tree.child(tree.nextSibling(status), "tracks");
+    QCOMPARE(tree.isList(tracks), true);
+    QCOMPARE(tree.childCount(tracks), 2);
+    QCOMPARE(tree.isList(tree.firstChild(tracks)), false);
+
+    QStringList names;
+    for (int track = tree.firstChild(tracks); track >= 0; track = tree.nextSibling(track)) {
+        QCOMPARE(tree.parent(track), tracks);
+        QCOMPARE(tree.nameId(track), tree.findName("track"));
+        names.append(tree.text(tree.child(track, "name")).toString());
+    }
+    QCOMPARE(names, QStringList() << "track1" << "track2");
+
+    // Tree is reusable
+    tree.clear();
+    QCOMPARE(tree.isEmpty(), true);
+    QCOMPARE(tree.parse("<smoozik><status>failed</status></smoozik>"), true);
+    QCOMPARE(tree.count(), 2);
+    QCOMPARE(tree.text(tree.child(tree.root(), "status")).toString(), QString("failed"));
+}
+
+void TestSmoozikXmlTree::internName()
+{
+    SmoozikXmlNameTable table;
+    QString name = "internNameTest";
+    QCOMPARE(table.find(name), -1);
+
+    int id = table.intern(QStringRef(&name));
+    QVERIFY(id >= 0);
+    QCOMPARE(table.find(name), id);
+    QCOMPARE(table.intern(QStringRef(&name)), id);
+    QCOMPARE(table.name(id), name);
+    QCOMPARE(table.count(), 1);
+
+    // Names are owned by each tree
+    SmoozikXmlTree tree1;
+    SmoozikXmlTree tree2;
+    QCOMPARE(tree1.parse("<internNameTest/>"), true);
+    QCOMPARE(tree2.parse("<a><internNameTest/></a>"), true);
+    QCOMPARE(tree1.findName(name), tree1.nameId(tree1.root()));
+    QCOMPARE(tree2.findName(name), tree2.nameId(tree2.firstChild(tree2.root())));
+    QCOMPARE(tree1.findName("a"), -1);
+    QCOMPARE(tree2.internedName(tree2.nameId(tree2.root())), QString("a"));
+
+    // Names are kept from one response to another, up to SmoozikXmlNameTable::MaxCount
+    int nameId = tree1.nameId(tree1.root());
+    QCOMPARE(tree1.parse("<internNameTest/>"), true);
+    QCOMPARE(tree1.nameId(tree1.root()), nameId);
+
+    QByteArray data("<a>");
+    for (int i = 0; i < SmoozikXmlNameTable::MaxCount; i++) {
+        data += QString("<n%1/>").arg(i).toUtf8();
+    }
+    data += "</a>";
+    QCOMPARE(tree1.parse(data), true);
+    QVERIFY(tree1.findName("n0") >= 0);
+    tree1.clear();
+    QCOMPARE(tree1.findName("n0"), -1);
+}
+
+void TestSmoozikXmlTree::parseError()
+{
+    SmoozikXmlTree tree;
+    QCOMPARE(tree.parse("<smoozik><status>ok</status>"), false);
+    QCOMPARE(tree.errorString().isEmpty(), false);
+    QCOMPARE(tree.isEmpty(), true);
+
+    QCOMPARE(tree.parse("<smoozik></status>"), false);
+    QCOMPARE(tree.isEmpty(), true);
+
+    QCOMPARE(tree.parse("<smoozik/>"), true);
+    QCOMPARE(tree.errorString(), QString());
+}
+
+void TestSmoozikXmlTree::benchmark_data()
+{
+    QTest::addColumn<int>("parser");
+
+    QTest::newRow("QDomDocument") << 0;
+    QTest::newRow("SmoozikXml") << 1;
+    QTest::newRow("SmoozikXmlTree") << 2;
+}
+
+void TestSmoozikXmlTree::benchmark()
+{
+    QFETCH(int, parser);
+
+    // getTopTracks response with MAX_ADVISED_PLAYLIST_SIZE tracks
+    QByteArray data = "<smoozik><status>ok</status><data><tracks>";
+    for (int i = 0; i < 200; i++) {
+        data += QString("<track><localId>%1</localId><name>Track %1</name><artist>Artist %2</artist><album>Album %2</album><duration>%3</duration></track>")
+                .arg(i).arg(i / 10).arg(180 + i).toUtf8();
+    }
+    data += "</tracks></data></smoozik>";
+
+    int count = 0;
+    if (parser == 0) {
+        QBENCHMARK {
+            QDomDocument doc;
+            doc.setContent(data);
+            QVariant variant = SmoozikXml::parseElement(doc.documentElement().firstChildElement("data"));
+            count = variant.toMap()["tracks"].toList().count();
+        }
+    } else if (parser == 1) {
+        QBENCHMARK {
+            SmoozikXml xml;
+            xml.addData(data);
+            xml.finish();
+            count = xml["tracks"].toList().count();
+        }
+    } else {
+        SmoozikXmlTree tree;
+        QBENCHMARK {
+            tree.parse(data);
+            int tracks = tree.child(tree.child(tree.root(), "data"), "tracks");
+            count = 0;
+            for (int track = tree.firstChild(tracks); track >= 0; track = tree.nextSibling(track)) {
+                count++;
+            }
+        }
+    }
+    QCOMPARE(count, 200);
+}
+
+QTEST_XML_MAIN(TestSmoozikXmlTree)
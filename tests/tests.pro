@@ -1,5 +1,17 @@
 TEMPLATE = subdirs
 SUBDIRS += smoozikxml \
+    smoozikjson \
+    smoozikxmltree \
+    smoozikxmlpool \
+    smooziktrackdata \
     smooziktrack \
     smoozikplaylist \
-    smoozikmanager
+    smoozikplaylistdelta \
+    smoozikplaylistsnapshot \
+    smooziktrackcatalog \
+    smoozikplaylistview \
+    smooziktracktable \
+    smoozikrandom \
+    smoozikmanager \
+    smoozikreply \
+    smoozikrequestencoder